@@ -0,0 +1,221 @@
+// runs compiler over generated programs and reports its throughput.
+// usage: bench [runs], from root of repository after `./build`.
+// results are appended to `bench/out/results.csv`, which is not tracked, so they are only compared
+// with runs on same machine. throughput which dropped below last result of same program
+// by more than BENCH_TOLERANCE is reported as regression.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#define BENCH_RUNS 3
+#define BENCH_TOLERANCE 0.10
+#define BENCH_OUTPUT "bench/out/"
+#define BENCH_RESULTS BENCH_OUTPUT "results.csv"
+
+#define BENCH_HEADER "date,commit,program,size,tokens,nodes,asm_bytes,lex_ms,parse_ms,emit_ms,total_ms,tokens_per_s,nodes_per_s,asm_bytes_per_s\n"
+
+// sizes stay below limits of compiler (1024 symbols), each program
+// compiles in less than a second.
+static const struct {
+	const char *kind;
+	uint64_t size;
+} PROGRAMS[] = {
+	{ "globals", 800 },
+	{ "expression", 2000 },
+	{ "statements", 20000 },
+	{ "identifiers", 900 },
+	{ "strings", 65536 },
+};
+
+typedef struct {
+	uint64_t tokens, nodes, asm_bytes;
+	double lex, parse, emit, total;
+	double tokens_per_s, nodes_per_s, asm_bytes_per_s;
+} result_T;
+
+static char *read_all(const char *path)
+{
+	FILE *file = fopen(path, "r");
+	if (!file) return NULL;
+
+	fseek(file, 0, SEEK_END);
+	long length = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	char *content = length < 0 ? NULL : calloc(length + 1, 1);
+	// partly read report would give wrong numbers, it is treated as missing.
+	if (content && fread(content, 1, length, file) != (size_t)length)
+	{
+		free(content);
+		content = NULL;
+	}
+	fclose(file);
+
+	return content;
+}
+
+// number after `"key": ` which follows `after` in report of compiler.
+static double json_number(const char *json, const char *after, const char *key)
+{
+	const char *at = after ? strstr(json, after) : json;
+	if (!at) return 0;
+
+	char pattern[64];
+	snprintf(pattern, sizeof(pattern), "\"%s\": ", key);
+	at = strstr(at, pattern);
+
+	return at ? strtod(at + strlen(pattern), NULL) : 0;
+}
+
+static double phase_ms(const char *json, const char *phase)
+{
+	char after[64];
+	snprintf(after, sizeof(after), "\"name\": \"%s\"", phase);
+	return json_number(json, after, "wall_ms");
+}
+
+static double minimum(double a, double b)
+{
+	return a < b ? a : b;
+}
+
+// best of runs, so noise of machine only makes results slower.
+static bool measure(const char *kind, uint64_t size, int runs, result_T *result)
+{
+	char command[256];
+	snprintf(command, sizeof(command), "bin/bench_gen %s %ld > " BENCH_OUTPUT "%s.tl", kind, size, kind);
+	if (system(command)) return false;
+
+	*result = (result_T){ .lex = 1e18, .parse = 1e18, .emit = 1e18, .total = 1e18 };
+	for (int i = 0; i < runs; ++i)
+	{
+		snprintf(command, sizeof(command),
+			"cd " BENCH_OUTPUT " && ../../bin/tlang %s.tl --no-cache --time-report=json > /dev/null 2> %s.json", kind, kind);
+		if (system(command)) return false;
+
+		char path[256];
+		snprintf(path, sizeof(path), BENCH_OUTPUT "%s.json", kind);
+		char *json = read_all(path);
+		if (!json) return false;
+
+		result->lex = minimum(result->lex, phase_ms(json, "lex"));
+		result->parse = minimum(result->parse, phase_ms(json, "parse"));
+		result->emit = minimum(result->emit, phase_ms(json, "emit"));
+		result->total = minimum(result->total, json_number(json, "\"total\"", "wall_ms"));
+		result->tokens = json_number(json, "\"counters\"", "tokens");
+		result->nodes = json_number(json, "\"counters\"", "nodes");
+		result->asm_bytes = json_number(json, "\"counters\"", "asm_bytes");
+		free(json);
+	}
+
+	result->tokens_per_s = result->tokens / (result->lex / 1e3);
+	result->nodes_per_s = result->nodes / (result->parse / 1e3);
+	result->asm_bytes_per_s = result->asm_bytes / (result->emit / 1e3);
+
+	return true;
+}
+
+// throughput of program in last line of results written for it, false if there is none.
+static bool previous(const char *results, const char *kind, result_T *result)
+{
+	bool found = false;
+	if (!results) return false;
+
+	for (const char *line = results; *line; line = strchr(line, '\n') ? strchr(line, '\n') + 1 : "")
+	{
+		char date[32], commit[64], program[64];
+		uint64_t size;
+		result_T row;
+
+		int n = sscanf(line, "%31[^,],%63[^,],%63[^,],%lu,%lu,%lu,%lu,%lf,%lf,%lf,%lf,%lf,%lf,%lf",
+			date, commit, program, &size, &row.tokens, &row.nodes, &row.asm_bytes,
+			&row.lex, &row.parse, &row.emit, &row.total,
+			&row.tokens_per_s, &row.nodes_per_s, &row.asm_bytes_per_s);
+		if (n != 14 || strcmp(program, kind)) continue;
+
+		*result = row;
+		found = true;
+	}
+
+	return found;
+}
+
+static bool regressed(const char *metric, double now, double before)
+{
+	if (now >= before * (1 - BENCH_TOLERANCE)) return false;
+
+	printf("  regression :: %s dropped from %.0f to %.0f (%.1f%%)\n",
+		metric, before, now, (before - now) / before * 100);
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	int runs = argc > 1 ? atoi(argv[1]) : BENCH_RUNS;
+	if (runs <= 0) runs = BENCH_RUNS;
+
+	mkdir(BENCH_OUTPUT, 0755);
+	char *results = read_all(BENCH_RESULTS);
+
+	FILE *csv = fopen(BENCH_RESULTS, "a");
+	if (!csv)
+	{
+		perror("err :: failed to open " BENCH_RESULTS ": ");
+		return -1;
+	}
+	if (!results || !*results) fprintf(csv, BENCH_HEADER);
+
+	char commit[64] = "unknown";
+	FILE *git = popen("git rev-parse --short HEAD 2>/dev/null", "r");
+	if (git)
+	{
+		if (fscanf(git, "%63s", commit) != 1) strcpy(commit, "unknown");
+		pclose(git);
+	}
+
+	char date[32];
+	time_t now = time(NULL);
+	strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+	printf("%-12s %10s %10s %10s %12s %14s %14s %16s\n",
+		"program", "tokens", "nodes", "asm bytes", "total (ms)", "tokens/s", "nodes/s", "asm bytes/s");
+
+	bool regression = false;
+	for (size_t i = 0; i < sizeof(PROGRAMS) / sizeof(PROGRAMS[0]); ++i)
+	{
+		const char *kind = PROGRAMS[i].kind;
+		result_T result, before;
+
+		if (!measure(kind, PROGRAMS[i].size, runs, &result))
+		{
+			printf("err :: failed to compile `%s`.\n", kind);
+			regression = true;
+			continue;
+		}
+
+		printf("%-12s %10ld %10ld %10ld %12.3f %14.0f %14.0f %16.0f\n",
+			kind, result.tokens, result.nodes, result.asm_bytes, result.total,
+			result.tokens_per_s, result.nodes_per_s, result.asm_bytes_per_s);
+
+		if (previous(results, kind, &before))
+		{
+			regression |= regressed("tokens/s", result.tokens_per_s, before.tokens_per_s);
+			regression |= regressed("nodes/s", result.nodes_per_s, before.nodes_per_s);
+			regression |= regressed("asm bytes/s", result.asm_bytes_per_s, before.asm_bytes_per_s);
+		}
+
+		fprintf(csv, "%s,%s,%s,%ld,%ld,%ld,%ld,%.3f,%.3f,%.3f,%.3f,%.0f,%.0f,%.0f\n",
+			date, commit, kind, PROGRAMS[i].size, result.tokens, result.nodes, result.asm_bytes,
+			result.lex, result.parse, result.emit, result.total,
+			result.tokens_per_s, result.nodes_per_s, result.asm_bytes_per_s);
+	}
+
+	fclose(csv);
+	free(results);
+
+	return regression;
+}
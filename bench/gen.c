@@ -0,0 +1,137 @@
+// generator of synthetic tlang programs, each kind stresses one part of compiler.
+// usage: gen <kind> <size>, program is written to stdout.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+// symbol table of compiler holds 1024 symbols, locals are never released
+#define GEN_MAX_SYMBOLS 900
+
+typedef void (*generator_T)(uint64_t size);
+
+// N globals, half of them zero (.bss), all of them read by main.
+static void gen_globals(uint64_t size)
+{
+	if (size > GEN_MAX_SYMBOLS) size = GEN_MAX_SYMBOLS;
+
+	for (uint64_t i = 0; i < size; ++i)
+		printf(i % 2 ? "g%ld: i64;\n" : "g%ld: i64 = %ld;\n", i, i);
+
+	printf("\nmain(): i32 -> {\n\ts: i64 = 0;\n");
+	for (uint64_t i = 0; i < size; ++i)
+		printf("\ts = s + g%ld;\n", i);
+	printf("\treturn s;\n}\n");
+}
+
+// one expression nested `size` levels deep.
+static void gen_expression(uint64_t size)
+{
+	static const char *ops[] = { "+", "-", "*", "/", "%" };
+
+	printf("value(x: i64): i64 -> {\n\treturn ");
+	for (uint64_t i = 0; i < size; ++i) printf("(");
+	printf("x");
+	for (uint64_t i = 0; i < size; ++i)
+		printf(" %s %ld)", ops[i % 5], i % 7 + 1);
+	printf(";\n}\n\nmain(): i32 -> {\n\treturn value(3);\n}\n");
+}
+
+// long list of statements over a few locals.
+static void gen_statements(uint64_t size)
+{
+	printf("main(): i32 -> {\n\ta: i64 = 1;\n\tb: i64 = 2;\n\tc: i64 = 3;\n");
+	for (uint64_t i = 0; i < size; ++i)
+	{
+		switch (i % 4)
+		{
+			case 0: printf("\ta = a + b * %ld;\n", i % 13); break;
+			case 1: printf("\tb = b - c / %ld;\n", i % 11 + 1); break;
+			case 2: printf("\tif (a < b) c = c + 1;\n"); break;
+			case 3: printf("\tc = c %% %ld + a;\n", i % 5 + 1); break;
+		}
+	}
+	printf("\treturn a + b + c;\n}\n");
+}
+
+// many locals with long names, spread over functions.
+static void gen_identifiers(uint64_t size)
+{
+	if (size > GEN_MAX_SYMBOLS) size = GEN_MAX_SYMBOLS;
+
+	uint64_t per_function = 64;
+	uint64_t functions = (size + per_function - 1) / per_function;
+
+	for (uint64_t f = 0; f < functions; ++f)
+	{
+		printf("@noinline\nidentifiers_of_function_%ld(): i64 -> {\n", f);
+		uint64_t first = f * per_function, last = first + per_function;
+		if (last > size) last = size;
+
+		for (uint64_t i = first; i < last; ++i)
+			printf("\tlocal_identifier_with_long_name_%ld: i64 = %ld;\n", i, i);
+
+		printf("\treturn local_identifier_with_long_name_%ld", first);
+		for (uint64_t i = first + 1; i < last; ++i)
+			printf(" + local_identifier_with_long_name_%ld", i);
+		printf(";\n}\n\n");
+	}
+
+	printf("main(): i32 -> {\n\ts: i64 = 0;\n");
+	for (uint64_t f = 0; f < functions; ++f)
+		printf("\ts = s + identifiers_of_function_%ld();\n", f);
+	printf("\treturn s;\n}\n");
+}
+
+// literals of `size` bytes in total, every third one repeats the first.
+static void gen_strings(uint64_t size)
+{
+	uint64_t length = 1024;
+	uint64_t count = (size + length - 1) / length;
+
+	printf("main(): i32 -> {\n");
+	for (uint64_t i = 0; i < count; ++i)
+	{
+		uint64_t seed = i % 3 ? i : 0;
+
+		printf("\tprint(\"");
+		for (uint64_t j = 0; j < length; ++j)
+			putchar('a' + (seed * 7 + j) % 26);
+		printf("\\n\");\n");
+
+		if (i % 4 == 0) printf("\tputchar(10);\n");
+	}
+	printf("\treturn 0;\n}\n");
+}
+
+static const struct {
+	const char *kind;
+	generator_T generate;
+} GENERATORS[] = {
+	{ "globals", gen_globals },
+	{ "expression", gen_expression },
+	{ "statements", gen_statements },
+	{ "identifiers", gen_identifiers },
+	{ "strings", gen_strings },
+};
+
+int main(int argc, char **argv)
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "usage: %s <kind> <size>\n", argv[0]);
+		return -1;
+	}
+
+	uint64_t size = strtoull(argv[2], NULL, 10);
+	for (size_t i = 0; i < sizeof(GENERATORS) / sizeof(GENERATORS[0]); ++i)
+	{
+		if (strcmp(GENERATORS[i].kind, argv[1])) continue;
+
+		GENERATORS[i].generate(size);
+		return 0;
+	}
+
+	fprintf(stderr, "unknown kind `%s`.\n", argv[1]);
+	return -1;
+}
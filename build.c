@@ -3,28 +3,373 @@
 
 #define PROJECT_NAME 			"tlang"
 #define PROJECT_BIN				"bin/"
+#define PROJECT_OBJ				"bin/obj/"
 #define PROJECT_SRC				"src/"
 #define PROJECT_INCLUDE		"src/"
+#define RUNTIME_NAME			"libtl.a"
+#define RUNTIME_SRC				"runtime/"
+#define RUNTIME_OBJ				"bin/obj/runtime/"
+#define BENCH_SRC					"bench/"
+#define CHECK_SRC					"check/"
+#define CHECK_OUTPUT			"bin/check/"
 
 const char *build_source = "build.c";
 const char *build_bin = "build";
 
-void build_start(int argc, char **argv)
+// objects of each profile are kept in own directory under PROJECT_OBJ.
+typedef struct {
+	const char *name;
+	const char *cflags;
+	const char *ldflags;
+} profile_T;
+
+#define PROFILE_WARNINGS "-Wall -Wextra"
+
+static const profile_T PROFILES[] = {
+	{ "debug", 		"-O0 -g " PROFILE_WARNINGS, "-g" },
+	{ "release", 	"-O2 -march=native " PROFILE_WARNINGS, "" },
+	{ "lto", 			"-O2 -march=native -flto=auto " PROFILE_WARNINGS, "-O2 -march=native -flto=auto" },
+	// compiled twice: instrumented, trained on benchmark programs, then with collected profile.
+	{ "pgo", 			"-O2 -march=native " PROFILE_WARNINGS, "" },
+};
+
+// programs of `bench/gen.c` which instrumented compiler runs to collect profile,
+// smaller than benchmark so training stays quick.
+static const struct {
+	const char *kind;
+	const char *size;
+} TRAINING[] = {
+	{ "globals", "400" },
+	{ "expression", "500" },
+	{ "statements", "500" },
+	{ "identifiers", "400" },
+	{ "strings", "16384" },
+};
+
+// files which object depends on, from `object: source headers...` rule written by `gcc -MMD`.
+// NULL if object was never compiled.
+static array_T *read_dependencies(const char *path)
 {
-	// create bin folder if it does not exist.
-	create_directory("bin");
+	FILE *file = fopen(path, "r");
+	if (file == NULL) return NULL;
+
+	array_T *dependencies = init_array(sizeof(const char *));
+	char name[PATH_MAX];
+	size_t length = 0;
+	bool target = true;
+	int c, previous = 0;
+
+	// first rule ends at newline which is not escaped, `-MP` adds empty rules after it.
+	while ((c = fgetc(file)) != EOF && !(c == '\n' && previous != '\\'))
+	{
+		previous = c;
+		if (target)
+		{
+			target = c != ':';
+			continue;
+		}
+
+		if (c != ' ' && c != '\n' && c != '\\' && length < PATH_MAX - 1)
+		{
+			name[length++] = c;
+			continue;
+		}
+
+		if (length == 0) continue;
+		name[length] = '\0';
+		array_push(dependencies, (void*)formate_string("%s", name));
+		length = 0;
+	}
+
+	if (length)
+	{
+		name[length] = '\0';
+		array_push(dependencies, (void*)formate_string("%s", name));
+	}
+
+	fclose(file);
+	return dependencies;
+}
+
+static bool object_is_stale(const char *object, const char *dependency_file)
+{
+	if (!file_exist(object)) return true;
+
+	array_T *dependencies = read_dependencies(dependency_file);
+	if (dependencies == NULL) return true;
+
+	bool stale = binary_test(object, dependencies);
+	array_free(dependencies);
+
+	return stale;
+}
+
+// runs commands in shell, at most `jobs` of them at once.
+// no more commands are started after one of them fails.
+static bool execute_parallel(array_T *commands, int jobs)
+{
+	pid_t *running = calloc(jobs, sizeof(pid_t));
+	const char **running_commands = calloc(jobs, sizeof(const char *));
+	size_t next = 0;
+	int active = 0;
+	bool success = true;
+
+	while ((success && next < commands->index) || active > 0)
+	{
+		while (success && active < jobs && next < commands->index)
+		{
+			const char *command = array_get(commands, next++);
+			pid_t pid = fork();
+
+			if (pid == 0)
+			{
+				execl("/bin/sh", "sh", "-c", command, (char*)NULL);
+				_exit(127);
+			}
+
+			if (pid < 0)
+			{
+				perror("failed to start job: ");
+				success = false;
+				break;
+			}
+
+			for (int i = 0; i < jobs; ++i)
+			{
+				if (running[i]) continue;
+
+				running[i] = pid;
+				running_commands[i] = command;
+				break;
+			}
+			active++;
+		}
+
+		if (active == 0) break;
+
+		int status;
+		pid_t pid = wait(&status);
+		if (pid < 0) break;
+
+		for (int i = 0; i < jobs; ++i)
+		{
+			if (running[i] != pid) continue;
+
+			if (!WIFEXITED(status) || WEXITSTATUS(status))
+			{
+				WARN("failed: %s", running_commands[i]);
+				success = false;
+			}
+
+			running[i] = 0;
+			active--;
+			break;
+		}
+	}
+
+	free(running);
+	free(running_commands);
+
+	return success;
+}
+
+// compiles every `.c` of `src` into object of `obj`, objects which are newer than their
+// source and headers are kept. returns objects separated by space.
+static const char *compile_objects(const char *src, const char *obj, const char *flags, int jobs, bool force, bool *rebuilt)
+{
+	create_directory(obj);
+
+	array_T *sources = file_get_end(src, ".c");
+	array_T *commands = init_array(sizeof(const char *));
+	const char *objects = "";
+
+	for (size_t i = 0; i < sources->index; ++i)
+	{
+		const char *source = array_get(sources, i);
+		const char *name = strsub(source, strlen(src), strlen(source) - 2);
+		const char *object = formate_string("%s%s.o", obj, name);
+		const char *dependency_file = formate_string("%s%s.d", obj, name);
 
-	array_T *src_files_array = file_get_end(PROJECT_SRC, ".c");
-	const char *src_files = strconvCAtoCC(src_files_array, ' ');
-	array_free(src_files_array);
+		objects = formate_string("%s %s", objects, object);
+		if (!force && !object_is_stale(object, dependency_file)) continue;
 
+		array_push(commands, (void*)formate_string("gcc %s -MMD -MP -c %s -o %s", flags, source, object));
+	}
+	array_free(sources);
+
+	if (commands->index)
+	{
+		INFO("compiling %zu file(s) of %s with %d job(s).", commands->index, src, jobs);
+		*rebuilt = true;
+	}
+
+	if (!execute_parallel(commands, jobs))
+		ERROR("failed to compile %s.", src);
+	array_free(commands);
+
+	return objects;
+}
+
+static void link_compiler(const char *objects, const char *binary, const char *ldflags)
+{
+	// allocations are counted by wrappers for `--time-report`.
 	bool suc = command_execute(
 			formate_string(
-				"gcc -I%s %s -o %s%s",
-				PROJECT_INCLUDE,
-				src_files,
-				PROJECT_BIN,
-				PROJECT_NAME
+				"gcc %s %s -o %s -pthread -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc",
+				ldflags,
+				objects,
+				binary
 			)
 	);
+	if (suc) ERROR("failed to link %s.", binary);
+}
+
+static void build_bench_tools()
+{
+	if (command_execute(formate_string("gcc -O2 %s %sgen.c -o %sbench_gen", PROFILE_WARNINGS, BENCH_SRC, PROJECT_BIN)))
+		ERROR("failed to build benchmark generator.");
+	if (command_execute(formate_string("gcc -O2 %s %sbench.c -o %sbench", PROFILE_WARNINGS, BENCH_SRC, PROJECT_BIN)))
+		ERROR("failed to build benchmark harness.");
+}
+
+// `./build check` runs program of `check/divide.c`, which compares division by
+// constant with hardware division, it needs compiler, runtime and fasm2.
+static void build_check()
+{
+	if (command_execute(formate_string("gcc -O2 %s %sdivide.c -o %scheck_divide", PROFILE_WARNINGS, CHECK_SRC, PROJECT_BIN)))
+		ERROR("failed to build division check generator.");
+
+	create_directory(CHECK_OUTPUT);
+	if (command_execute(formate_string("%scheck_divide > %sdivide.tl", PROJECT_BIN, CHECK_OUTPUT)))
+		ERROR("failed to generate division check.");
+
+	INFO("checking division by constant.");
+	if (command_execute(formate_string("cd %s && ../%s divide.tl --no-cache > /dev/null", CHECK_OUTPUT, PROJECT_NAME)))
+		ERROR("compiler failed on division check.");
+	if (command_execute(formate_string(
+			"cd %s && fasm2 out.asm > /dev/null && ld out.o ../%s -o divide -dynamic-linker /usr/lib64/ld-linux-x86-64.so.2 -lc",
+			CHECK_OUTPUT, RUNTIME_NAME)))
+		ERROR("failed to assemble division check.");
+	if (command_execute(formate_string("%sdivide", CHECK_OUTPUT)))
+		ERROR("division by constant differs from hardware division.");
+}
+
+// instrumented compiler writes `.gcda` next to its objects, which are then
+// compiled again at same paths, so `-fprofile-use` finds them.
+static const char *build_pgo(const char *obj, const char *flags, int jobs)
+{
+	bool rebuilt = false;
+	const char *instrumented = formate_string("%s%s-instrumented", PROJECT_BIN, PROJECT_NAME);
+	const char *train = formate_string("%strain/", obj);
+
+	command_execute(formate_string("rm -f %s*.gcda", obj));
+	const char *objects = compile_objects(PROJECT_SRC, obj,
+		formate_string("%s -fprofile-generate", flags), jobs, true, &rebuilt);
+	link_compiler(objects, instrumented, "-fprofile-generate");
+
+	build_bench_tools();
+	create_directory(train);
+	for (size_t i = 0; i < sizeof(TRAINING) / sizeof(TRAINING[0]); ++i)
+	{
+		INFO("training on %s.", TRAINING[i].kind);
+		if (command_execute(formate_string("%sbench_gen %s %s > %s%s.tl",
+				PROJECT_BIN, TRAINING[i].kind, TRAINING[i].size, train, TRAINING[i].kind)))
+			ERROR("failed to generate training program %s.", TRAINING[i].kind);
+
+		if (command_execute(formate_string("cd %s && %s/%s %s.tl --no-cache > /dev/null",
+				train, getcwd(NULL, 0), instrumented, TRAINING[i].kind)))
+			ERROR("instrumented compiler failed on %s.", TRAINING[i].kind);
+	}
+
+	return compile_objects(PROJECT_SRC, obj,
+		formate_string("%s -fprofile-use -fprofile-partial-training -Wno-missing-profile", flags),
+		jobs, true, &rebuilt);
+}
+
+void build_start(int argc, char **argv)
+{
+	int jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	bool bench = false, check = false;
+	const char *bench_runs = "";
+	const profile_T *profile = &PROFILES[1];
+
+	// ./build [debug|release|lto|pgo] [-jN] [bench [runs]] [check]
+	for (int i = 1; i < argc; ++i)
+	{
+		const profile_T *named = NULL;
+		for (size_t j = 0; j < sizeof(PROFILES) / sizeof(PROFILES[0]); ++j)
+			if (!strcmp(argv[i], PROFILES[j].name)) named = &PROFILES[j];
+
+		if (named)
+			profile = named;
+		else if (!strncmp(argv[i], "-j", 2))
+			jobs = argv[i][2] ? atoi(argv[i] + 2) : (i + 1 < argc ? atoi(argv[++i]) : jobs);
+		else if (!strcmp(argv[i], "bench"))
+			bench = true;
+		else if (bench && atoi(argv[i]) > 0)
+			bench_runs = argv[i];
+		else if (!strcmp(argv[i], "check"))
+			check = true;
+		else
+			ERROR("unknown argument `%s`.", argv[i]);
+	}
+	if (jobs < 1) jobs = 1;
+
+	// create bin folder if it does not exist.
+	create_directory("bin");
+
+	bool rebuilt = false;
+	const char *obj = formate_string("%s%s/", PROJECT_OBJ, profile->name);
+	const char *flags = formate_string("-I%s -pthread %s", PROJECT_INCLUDE, profile->cflags);
+	const char *binary = formate_string("%s%s", PROJECT_BIN, PROJECT_NAME);
+
+	const char *objects = !strcmp(profile->name, "pgo") ?
+		(rebuilt = true, build_pgo(obj, flags, jobs)) :
+		compile_objects(PROJECT_SRC, obj, flags, jobs, false, &rebuilt);
+
+	// binary is relinked when it was built with another profile.
+	const char *stamp = formate_string("%sprofile", PROJECT_OBJ);
+	FILE *last = fopen(stamp, "r");
+	char last_profile[32] = "";
+	if (last)
+	{
+		if (!fgets(last_profile, sizeof(last_profile), last)) last_profile[0] = '\0';
+		fclose(last);
+	}
+
+	if (rebuilt || strcmp(last_profile, profile->name) || !file_exist(binary))
+	{
+		INFO("linking %s (%s).", PROJECT_NAME, profile->name);
+		link_compiler(objects, binary, profile->ldflags);
+
+		FILE *next = fopen(stamp, "w");
+		if (next)
+		{
+			fputs(profile->name, next);
+			fclose(next);
+		}
+	}
+
+	// runtime is linked into compiled programs, so it is built with optimizations.
+	rebuilt = false;
+	const char *runtime_objects = compile_objects(RUNTIME_SRC, RUNTIME_OBJ,
+		formate_string("-O2 -I%s %s", RUNTIME_SRC, PROFILE_WARNINGS), jobs, false, &rebuilt);
+	const char *runtime = formate_string("%s%s", PROJECT_BIN, RUNTIME_NAME);
+
+	if (rebuilt || !file_exist(runtime))
+	{
+		command_execute(formate_string("rm -f %s", runtime));
+		if (command_execute(formate_string("ar rcs %s%s", runtime, runtime_objects)))
+			ERROR("failed to archive %s.", RUNTIME_NAME);
+	}
+
+	// `./build bench [runs]` measures compiler on generated programs.
+	if (bench)
+	{
+		build_bench_tools();
+		if (command_execute(formate_string("%sbench %s", PROJECT_BIN, bench_runs)))
+			ERROR("benchmark found regression.");
+	}
+
+	if (check) build_check();
 }
@@ -460,7 +460,10 @@ void array_push(array_T *array, void *item)
 	}
 
 	if (array->index >= array->len)
-		array->buffer = realloc(array->buffer, (array->len + 10) * array->item_size);
+	{
+		array->len += 10;
+		array->buffer = realloc(array->buffer, array->len * array->item_size);
+	}
 
 	array->buffer[array->index++] = item;
 }
@@ -597,6 +600,7 @@ const char *strconvCCAtoCC(const char **CCA, size_t len, unsigned char sep)
 		total_size_of_string += strlen(CCA[i]) + 1;
 
 	char *string = arena_allocate(build_main_arena, total_size_of_string + 1);
+	string[0] = '\0';
 	size_t pos = 0;
 	for (size_t i = 0; i < len; ++i)
 	{
@@ -621,6 +625,7 @@ const char *strconvCAtoCC(array_T *array, unsigned sep)
 	}
 
 	char *string = arena_allocate(build_main_arena, total_size_of_string + 1);
+	string[0] = '\0';
 	size_t pos = 0;
 	for (size_t i = 0; i < array->index; ++i)
 	{
@@ -717,7 +722,7 @@ bool file_exist(const char *path)
 	FILE *file = fopen(path, "r");
 	if (file == NULL) return false;
 
-	free(file);
+	fclose(file);
 	return true;
 }
 
@@ -726,7 +731,7 @@ bool directory_exist(const char *path)
 	DIR *dir = opendir(path);
 	if (dir == NULL) return false;
 
-	free(dir);
+	closedir(dir);
 	return true;
 }
 
@@ -0,0 +1,183 @@
+// generator of tlang program which checks division by constant (multiply and shift
+// of `constant_divide`) against hardware division by same value passed at runtime.
+// usage: divide, program is written to stdout, it prints every mismatch and exits with 1.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct {
+	const char *name;
+	const char *format;
+	bool is_signed;
+	uint8_t bits;
+} type_T;
+
+static const type_T TYPES[] = {
+	{ "i32", "%d", true, 32 },
+	{ "u32", "%u", false, 32 },
+	{ "i64", "%ld", true, 64 },
+	{ "u64", "%lu", false, 64 },
+};
+
+#define TYPE_COUNT (sizeof(TYPES) / sizeof(TYPES[0]))
+
+// divisors are bit patterns, only those which fit in type are used.
+static const int64_t DIVISORS[] = {
+	1, 2, 4, 8, 16, 1024, 1 << 30, 1ll << 31, 1ll << 32, 1ll << 62, INT64_MIN,
+	3, 5, 6, 7, 10, 12, 25, 641, 1000003, INT32_MAX, UINT32_MAX, INT64_MAX,
+	-1, -2, -3, -7, -8, -10, -641, -1024, -1000003, -INT32_MAX, INT32_MIN,
+	-(1ll << 40) - 1,
+};
+
+#define DIVISOR_COUNT (sizeof(DIVISORS) / sizeof(DIVISORS[0]))
+
+// dividends around edges of every type, near multiples of divisor are added to them.
+static const int64_t DIVIDENDS[] = {
+	0, 1, 2, 3, 5, 6, 7, 8, 9, 100, 640, 641, 642, 1000002, 1000003, 123456789,
+	INT16_MAX, INT32_MAX - 1, INT32_MAX, 1ll << 31, UINT32_MAX - 1, UINT32_MAX, 1ll << 32,
+	INT64_MAX - 1, INT64_MAX, INT64_MIN, INT64_MIN + 1, INT32_MIN, INT32_MIN + 1,
+	-1, -2, -3, -6, -7, -8, -640, -641, -642, -1000003, -123456789,
+};
+
+#define DIVIDEND_COUNT (sizeof(DIVIDENDS) / sizeof(DIVIDENDS[0]))
+
+// random dividends per divisor, from fixed seed so every run checks same values.
+#define RANDOM_DIVIDENDS 8
+
+static uint64_t random_state = 0x9e3779b97f4a7c15;
+
+static uint64_t random_next()
+{
+	random_state ^= random_state << 13;
+	random_state ^= random_state >> 7;
+	random_state ^= random_state << 17;
+	return random_state;
+}
+
+// divisor which does not fit in type is not checked with it.
+static bool fits(const type_T *type, int64_t value)
+{
+	if (type->bits == 64) return true;
+
+	return type->is_signed ?
+		value >= INT32_MIN && value <= INT32_MAX :
+		value >= 0 && value <= UINT32_MAX;
+}
+
+// literals of tlang are not negative, so negative values are written as subtraction.
+static const char *literal(int64_t value)
+{
+	static char buffers[4][64];
+	static int next = 0;
+	char *buffer = buffers[next++ % 4];
+
+	if (value >= 0)
+		snprintf(buffer, sizeof(buffers[0]), "%ld", value);
+	else
+		snprintf(buffer, sizeof(buffers[0]), "(0 - %lu - 1)", (uint64_t)-(value + 1));
+
+	return buffer;
+}
+
+// name of divisor in function names, `m` stands for minus.
+static const char *divisor_name(int64_t d)
+{
+	static char buffer[64];
+	if (d >= 0) snprintf(buffer, sizeof(buffer), "%ld", d);
+	else snprintf(buffer, sizeof(buffer), "m%lu", (uint64_t)-(d + 1) + 1);
+
+	return buffer;
+}
+
+// INT_MIN / -1 traps in hardware, so it is not checked.
+static bool traps(const type_T *type, int64_t x, int64_t d)
+{
+	int64_t min = type->bits == 32 ? INT32_MIN : INT64_MIN;
+	return type->is_signed && d == -1 && x == min;
+}
+
+static void gen_functions(const type_T *type)
+{
+	const char *t = type->name;
+
+	// divisor is parameter, so it is not known at compile time and hardware divides.
+	printf("@noinline\ncheck_%s(x: %s, d: %s, q: %s, r: %s): i64 -> {\n", t, t, t, t, t);
+	printf("\tif (q != x / d) {\n\t\tprintf(\"err :: %s %s / %s gave %s, hardware %s.\\n\", x, d, q, x / d);\n\t\treturn 1;\n\t}\n",
+		t, type->format, type->format, type->format, type->format);
+	printf("\tif (r != x %% d) {\n\t\tprintf(\"err :: %s %s %%%% %s gave %s, hardware %s.\\n\", x, d, r, x %% d);\n\t\treturn 1;\n\t}\n",
+		t, type->format, type->format, type->format, type->format);
+	printf("\treturn 0;\n}\n\n");
+
+	for (size_t i = 0; i < DIVISOR_COUNT; ++i)
+	{
+		int64_t d = DIVISORS[i];
+		if (!fits(type, d)) continue;
+
+		const char *name = divisor_name(d);
+		printf("@noinline\ndiv_%s_%s(x: %s): %s -> {\n\treturn x / %s;\n}\n\n", t, name, t, t, literal(d));
+		printf("@noinline\nmod_%s_%s(x: %s): %s -> {\n\treturn x %% %s;\n}\n\n", t, name, t, t, literal(d));
+	}
+}
+
+static void gen_check(const type_T *type, int64_t x, int64_t d)
+{
+	const char *t = type->name, *name = divisor_name(d);
+
+	// global is read at runtime, so calls are not folded.
+	printf("\tx_%s = %s;\n", t, literal(x));
+	printf("\tfailed = failed + check_%s(x_%s, %s, div_%s_%s(x_%s), mod_%s_%s(x_%s));\n",
+		t, t, literal(d), t, name, t, t, name, t);
+}
+
+static void gen_checks(const type_T *type)
+{
+	printf("@noinline\ncheck_all_%s(): i64 -> {\n\tfailed: i64 = 0;\n", type->name);
+
+	for (size_t i = 0; i < DIVISOR_COUNT; ++i)
+	{
+		int64_t d = DIVISORS[i];
+		if (!fits(type, d)) continue;
+
+		// multiples near edges of type wrap around.
+		uint64_t u = d;
+		int64_t near[] = { u - 1, u, u + 1, 2 * u - 1, 2 * u, 2 * u + 1 };
+		for (size_t j = 0; j < DIVIDEND_COUNT + 6 + RANDOM_DIVIDENDS; ++j)
+		{
+			int64_t x =
+				j < DIVIDEND_COUNT ? DIVIDENDS[j] :
+				j < DIVIDEND_COUNT + 6 ? near[j - DIVIDEND_COUNT] :
+				(int64_t)random_next();
+
+			// values which do not fit are narrowed, as their type would hold them.
+			if (type->bits == 32)
+				x = type->is_signed ? (int32_t)x : (int64_t)(uint32_t)x;
+
+			if (!traps(type, x, d)) gen_check(type, x, d);
+		}
+	}
+
+	printf("\treturn failed;\n}\n\n");
+}
+
+int main()
+{
+	for (size_t i = 0; i < TYPE_COUNT; ++i)
+		printf("x_%s: %s;\n", TYPES[i].name, TYPES[i].name);
+	printf("\n");
+
+	for (size_t i = 0; i < TYPE_COUNT; ++i)
+	{
+		gen_functions(&TYPES[i]);
+		gen_checks(&TYPES[i]);
+	}
+
+	printf("main(): i32 -> {\n\tfailed: i64 = 0;\n");
+	for (size_t i = 0; i < TYPE_COUNT; ++i)
+		printf("\tfailed = failed + check_all_%s();\n", TYPES[i].name);
+	printf("\tif (failed) {\n\t\tprintf(\"err :: %%ld divisions by constant differ from hardware.\\n\", failed);\n\t\treturn 1;\n\t}\n");
+	printf("\treturn 0;\n}\n");
+
+	return 0;
+}
@@ -0,0 +1,194 @@
+#include "tl.h"
+
+#include <stdio.h>
+
+// header in front of each allocation, 16 bytes to keep alignment.
+typedef struct {
+	uint64_t class;
+	uint64_t size;
+} tl_header_T;
+
+// class of allocations which do not belong to any pool
+#define TL_LARGE 	TL_CLASSES
+#define TL_REGION (TL_CLASSES + 1)
+
+typedef struct TL_BLOCK_STRUCT {
+	struct TL_BLOCK_STRUCT *next;
+} tl_block_T;
+
+typedef struct TL_CHUNK_STRUCT {
+	struct TL_CHUNK_STRUCT *next;
+	uint64_t size;
+	uint64_t used;
+	uint64_t padding;
+	uint8_t data[];
+} tl_chunk_T;
+
+typedef struct {
+	tl_chunk_T *chunk;
+	uint64_t used;
+} tl_mark_T;
+
+// pools are per thread, so they do not need locks.
+static __thread tl_block_T *pools[TL_CLASSES];
+
+static __thread tl_chunk_T *region_first = NULL;
+static __thread tl_chunk_T *region_chunk = NULL;
+static __thread tl_mark_T region_marks[TL_MAX_REGIONS];
+static __thread int region_depth = 0;
+
+static void tl_out_of_memory(uint64_t size)
+{
+	fprintf(stderr, "err :: runtime :: failed to allocate %lu bytes.\n", size);
+	exit(1);
+}
+
+static uint64_t tl_class_of(uint64_t size)
+{
+	uint64_t class = 0, class_size = TL_MIN_CLASS;
+	while (class_size < size)
+	{
+		class_size <<= 1;
+		if (++class == TL_CLASSES) return TL_LARGE;
+	}
+
+	return class;
+}
+
+static void tl_pool_refill(uint64_t class)
+{
+	uint64_t block_size = sizeof(tl_header_T) + ((uint64_t)TL_MIN_CLASS << class);
+
+	uint8_t *chunk = malloc(TL_POOL_CHUNK);
+	if (!chunk) tl_out_of_memory(TL_POOL_CHUNK);
+
+	// chunks of pools are never given back, their blocks are reused.
+	for (uint64_t offset = 0; offset + block_size <= TL_POOL_CHUNK; offset += block_size)
+	{
+		tl_block_T *block = (tl_block_T*)(chunk + offset);
+		block->next = pools[class];
+		pools[class] = block;
+	}
+}
+
+static tl_chunk_T *tl_region_chunk(uint64_t size)
+{
+	if (size < TL_REGION_CHUNK) size = TL_REGION_CHUNK;
+
+	tl_chunk_T *chunk = malloc(sizeof(tl_chunk_T) + size);
+	if (!chunk) tl_out_of_memory(size);
+
+	chunk->next = NULL;
+	chunk->size = size;
+	chunk->used = 0;
+
+	return chunk;
+}
+
+static void *tl_region_alloc(uint64_t size)
+{
+	uint64_t need = (sizeof(tl_header_T) + size + 15) / 16 * 16;
+
+	if (!region_chunk)
+		region_first = region_chunk = tl_region_chunk(need);
+
+	// chunks after the current one were used by previous regions, they are reused.
+	while (region_chunk->used + need > region_chunk->size)
+	{
+		tl_chunk_T *next = region_chunk->next;
+		if (!next || next->size < need)
+		{
+			tl_chunk_T *chunk = tl_region_chunk(need);
+			chunk->next = next;
+			region_chunk->next = chunk;
+			next = chunk;
+		}
+
+		region_chunk = next;
+		region_chunk->used = 0;
+	}
+
+	tl_header_T *header = (tl_header_T*)(region_chunk->data + region_chunk->used);
+	region_chunk->used += need;
+
+	header->class = TL_REGION;
+	header->size = size;
+
+	return header + 1;
+}
+
+void *tl_alloc(uint64_t size)
+{
+	if (region_depth > 0) return tl_region_alloc(size);
+
+	uint64_t class = tl_class_of(size);
+	tl_header_T *header;
+
+	if (class == TL_LARGE)
+	{
+		header = malloc(sizeof(tl_header_T) + size);
+		if (!header) tl_out_of_memory(size);
+	}
+	else
+	{
+		if (!pools[class]) tl_pool_refill(class);
+
+		header = (tl_header_T*)pools[class];
+		pools[class] = pools[class]->next;
+	}
+
+	header->class = class;
+	header->size = size;
+
+	return header + 1;
+}
+
+void tl_free(void *pointer)
+{
+	if (!pointer) return;
+
+	tl_header_T *header = (tl_header_T*)pointer - 1;
+	switch (header->class)
+	{
+		case TL_LARGE:
+			free(header);
+			break;
+
+		// memory of region lives until its end.
+		case TL_REGION:
+			break;
+
+		default:
+		{
+			// free block reuses memory of header.
+			uint64_t class = header->class;
+			tl_block_T *block = (tl_block_T*)header;
+			block->next = pools[class];
+			pools[class] = block;
+		}
+	}
+}
+
+void tl_region_begin(void)
+{
+	if (region_depth == TL_MAX_REGIONS)
+	{
+		fprintf(stderr, "err :: runtime :: regions are nested deeper than %d.\n", TL_MAX_REGIONS);
+		exit(1);
+	}
+
+	region_marks[region_depth++] = (tl_mark_T){
+		.chunk = region_chunk,
+		.used = region_chunk ? region_chunk->used : 0
+	};
+}
+
+void tl_region_end(void)
+{
+	if (region_depth == 0) return;
+
+	// rewinding to the mark frees everything that was allocated since.
+	tl_mark_T mark = region_marks[--region_depth];
+	region_chunk = mark.chunk ? mark.chunk : region_first;
+	if (region_chunk) region_chunk->used = mark.used;
+}
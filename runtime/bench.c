@@ -0,0 +1,143 @@
+#include "tl.h"
+
+#include <stdio.h>
+#include <time.h>
+#include <x86intrin.h>
+
+typedef struct {
+	const char *name;
+	uint64_t iterations;
+	uint64_t warmup;
+	// iterations which have finished, warm-up included
+	uint64_t done;
+	bool running;
+	uint64_t start;
+	// cycles of reading the counter twice, subtracted from samples
+	uint64_t overhead;
+	uint64_t *samples;
+	// both clocks at start of first measured iteration, to turn cycles into time
+	struct timespec wall_start;
+	uint64_t cycles_start;
+} tl_bench_T;
+
+static __thread tl_bench_T benches[TL_MAX_BENCHES];
+static __thread int bench_depth = 0;
+
+// rdtscp waits for earlier instructions to finish, so body is not measured before it is done.
+static inline uint64_t tl_cycles(void)
+{
+	unsigned int aux;
+	return __rdtscp(&aux);
+}
+
+static double tl_seconds_since(struct timespec *start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int tl_compare_samples(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+	return (x > y) - (x < y);
+}
+
+// nearest-rank percentile of sorted samples
+static uint64_t tl_percentile(uint64_t *samples, uint64_t n, uint64_t p)
+{
+	uint64_t rank = (n * p + 99) / 100;
+	return samples[rank ? rank - 1 : 0];
+}
+
+void tl_bench_begin(const char *name, uint64_t iterations)
+{
+	if (bench_depth == TL_MAX_BENCHES)
+	{
+		fprintf(stderr, "err :: runtime :: benchmarks are nested too deep.\n");
+		exit(1);
+	}
+
+	tl_bench_T *bench = &benches[bench_depth++];
+	*bench = (tl_bench_T){
+		.name = name,
+		.iterations = iterations,
+		.warmup = iterations / TL_BENCH_WARMUP,
+		// count which does not fit in memory is not multiplied, it would wrap around
+		.samples = iterations <= SIZE_MAX / sizeof(uint64_t) ? malloc(iterations * sizeof(uint64_t)) : NULL,
+		.overhead = UINT64_MAX
+	};
+
+	if (!bench->samples)
+	{
+		fprintf(stderr, "err :: runtime :: failed to allocate samples of `%s`.\n", name);
+		exit(1);
+	}
+
+	for (int i = 0; i < 64; ++i)
+	{
+		uint64_t start = tl_cycles();
+		uint64_t cycles = tl_cycles() - start;
+		if (cycles < bench->overhead) bench->overhead = cycles;
+	}
+}
+
+static void tl_bench_report(tl_bench_T *bench)
+{
+	double seconds = tl_seconds_since(&bench->wall_start);
+	uint64_t cycles = tl_cycles() - bench->cycles_start;
+	double ns_per_cycle = cycles ? seconds * 1e9 / cycles : 0;
+
+	qsort(bench->samples, bench->iterations, sizeof(uint64_t), tl_compare_samples);
+	uint64_t median = tl_percentile(bench->samples, bench->iterations, 50);
+	uint64_t p99 = tl_percentile(bench->samples, bench->iterations, 99);
+
+	// mean comes from wall time, so unlike samples it includes cost of timing loop.
+	tl_flush();
+	fprintf(stderr,
+		"bench :: %s: %lu iterations, median %lu cycles (%.1f ns), p99 %lu cycles (%.1f ns), "
+		"min %lu cycles, mean %.1f ns\n",
+		bench->name, bench->iterations, median, median * ns_per_cycle, p99, p99 * ns_per_cycle,
+		bench->samples[0], seconds * 1e9 / bench->iterations);
+}
+
+int tl_bench_next(void)
+{
+	uint64_t now = tl_cycles();
+	tl_bench_T *bench = &benches[bench_depth - 1];
+
+	if (bench->running)
+	{
+		uint64_t cycles = now - bench->start;
+		cycles = cycles > bench->overhead ? cycles - bench->overhead : 0;
+
+		if (bench->done >= bench->warmup) bench->samples[bench->done - bench->warmup] = cycles;
+		bench->done++;
+	}
+
+	if (bench->done == bench->warmup + bench->iterations)
+	{
+		tl_bench_report(bench);
+		tl_bench_cancel();
+		return 0;
+	}
+
+	// first measured iteration starts
+	if (bench->done == bench->warmup)
+	{
+		clock_gettime(CLOCK_MONOTONIC, &bench->wall_start);
+		bench->cycles_start = tl_cycles();
+	}
+
+	bench->running = true;
+	bench->start = tl_cycles();
+	return 1;
+}
+
+void tl_bench_cancel(void)
+{
+	if (bench_depth == 0) return;
+
+	free(benches[--bench_depth].samples);
+}
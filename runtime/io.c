@@ -0,0 +1,100 @@
+#include "tl.h"
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <unistd.h>
+
+static __thread char output[TL_OUTPUT_BUFFER];
+static __thread uint64_t output_used = 0;
+
+static void tl_write_all(const char *s, uint64_t length)
+{
+	while (length > 0)
+	{
+		ssize_t n = write(STDOUT_FILENO, s, length);
+		if (n <= 0) return;
+
+		s += n;
+		length -= n;
+	}
+}
+
+void tl_flush(void)
+{
+	tl_write_all(output, output_used);
+	output_used = 0;
+}
+
+void tl_write(const char *s, uint64_t length)
+{
+	if (output_used + length > TL_OUTPUT_BUFFER)
+	{
+		tl_flush();
+
+		// large writes do not go through buffer.
+		if (length >= TL_OUTPUT_BUFFER)
+		{
+			tl_write_all(s, length);
+			return;
+		}
+	}
+
+	memcpy(output + output_used, s, length);
+	output_used += length;
+}
+
+void tl_print(const char *s)
+{
+	tl_write(s, tl_length(s));
+}
+
+int tl_putchar(int c)
+{
+	if (output_used == TL_OUTPUT_BUFFER) tl_flush();
+	output[output_used++] = (char)c;
+
+	return (unsigned char)c;
+}
+
+int tl_printf(const char *format, ...)
+{
+	va_list ap, copy;
+	va_start(ap, format);
+	va_copy(copy, ap);
+
+	uint64_t room = TL_OUTPUT_BUFFER - output_used;
+	int n = vsnprintf(output + output_used, room, format, ap);
+	va_end(ap);
+
+	if (n < 0)
+	{
+		va_end(copy);
+		return n;
+	}
+
+	if ((uint64_t)n < room) output_used += n;
+	else
+	{
+		// did not fit, format again into memory which is large enough.
+		char *s = malloc(n + 1);
+		if (!s)
+		{
+			va_end(copy);
+			return -1;
+		}
+
+		vsnprintf(s, n + 1, format, copy);
+		tl_write(s, n);
+		free(s);
+	}
+
+	va_end(copy);
+	return n;
+}
+
+void tl_exit(int status)
+{
+	tl_flush();
+	exit(status);
+}
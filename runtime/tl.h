@@ -0,0 +1,67 @@
+#ifndef __tl_h__
+#define __tl_h__
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdbool.h>
+
+// smallest size class, each next class is twice as large
+#define TL_MIN_CLASS 16
+
+// number of size classes, larger allocations go straight to malloc
+#define TL_CLASSES 8
+
+// size of memory which is split into blocks of one size class
+#define TL_POOL_CHUNK (64 * 1024)
+
+// size of memory that is reserved for regions at once
+#define TL_REGION_CHUNK (256 * 1024)
+
+// max depth of nested regions
+#define TL_MAX_REGIONS 64
+
+// size of per-thread output buffer
+#define TL_OUTPUT_BUFFER (64 * 1024)
+
+// max depth of nested benchmarks
+#define TL_MAX_BENCHES 16
+
+// one warm-up iteration runs before every this many measured ones
+#define TL_BENCH_WARMUP 10
+
+// allocate memory, from the current region if there is one
+void *tl_alloc(uint64_t size);
+
+// give memory back to its pool, memory of region is freed at end of region
+void tl_free(void *pointer);
+
+// all allocations until `tl_region_end` are freed at once
+void tl_region_begin(void);
+void tl_region_end(void);
+
+// output is buffered, and written with single `write` when buffer is full
+// or `tl_flush` is called
+void tl_write(const char *s, uint64_t length);
+void tl_print(const char *s);
+
+// strings of program are preceded by their length
+static inline uint64_t tl_length(const char *s)
+{
+	return ((const uint64_t *)s)[-1];
+}
+
+int tl_printf(const char *format, ...);
+int tl_putchar(int c);
+void tl_flush(void);
+
+// flush output and exit
+void tl_exit(int status);
+
+// `@bench` block: `tl_bench_next` is called before each iteration and returns 0
+// when all of them ran, then median and p99 of iterations are printed to stderr.
+void tl_bench_begin(const char *name, uint64_t iterations);
+int tl_bench_next(void);
+// benchmark is left by return, nothing is printed
+void tl_bench_cancel(void);
+
+#endif // __tl_h__
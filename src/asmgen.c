@@ -1,39 +1,99 @@
 #include "asmgen.h"
+#include <pthread.h>
 
-static char *section_text = NULL;
+static char *section_func = NULL;
 static char *section_data = NULL;
+static char *section_rodata = NULL;
+static char *section_bss = NULL;
+static bool *data_defined = NULL;
+static list_T *globals = NULL;
+static uint64_t *global_weight = NULL;
 static FILE *OUTPUT = NULL;
 
-static const char *r64[] = { "rax", "rbx", "rcx", "rdx" };
-static const char *r32[] = { "eax", "ebx", "ecx", "edx" };
-static const char *r16[] = { "ax", "bx", "cx", "dx" };
-static const char *r8[] = { "al", "bl", "cl", "dl" };
-static bool reg_free[4] = { true };
+static const char *r64[] = { "rax", "rbx", "rcx", "rdx", "rsi", "rdi", "r8", "r9", "r10", "r11" };
+static const char *r32[] = { "eax", "ebx", "ecx", "edx", "esi", "edi", "r8d", "r9d", "r10d", "r11d" };
+static const char *r16[] = { "ax", "bx", "cx", "dx", "si", "di", "r8w", "r9w", "r10w", "r11w" };
+static const char *r8[] = { "al", "bl", "cl", "dl", "sil", "dil", "r8b", "r9b", "r10b", "r11b" };
 
-static char **FROM = NULL;
-static int		REG_ID = -1;
+// registers for evaluating expressions, they do not overlap with arguments.
+// rbx is callee-saved, so function using it will save it.
+#define POOL_SIZE 4
+static const int pool[POOL_SIZE] = { 0, 8, 9, 1 };
 
-const char *get_reg(const char *from[4])
+// System V AMD64 argument registers
+static const int int_args[6] = { 5, 4, 3, 2, 6, 7 };
+static const char *sse_args[8] = { "xmm0", "xmm1", "xmm2", "xmm3", "xmm4", "xmm5", "xmm6", "xmm7" };
+
+// context which is being generated by this thread, top level code or one function.
+static __thread codegen_T *CG = NULL;
+
+// functions in order they were defined, their contexts and next one to generate
+static list_T *PENDING = NULL;
+static codegen_T *CONTEXTS = NULL;
+static size_t NEXT_FUNCTION = 0;
+
+// code is appended to text of context, buffer of text grows twice as large when it is full.
+void append_text(const char *code)
+{
+	size_t length = strlen(code);
+	if (!CG->text_capacity) CG->text_length = strlen(CG->text);
+
+	if (CG->text_length + length + 1 > CG->text_capacity)
+	{
+		size_t capacity = 2 * (CG->text_length + length + 1);
+		char *text = malloc(capacity);
+		memcpy(text, CG->text, CG->text_length);
+		if (CG->text_capacity) free(CG->text);
+
+		CG->text = text;
+		CG->text_capacity = capacity;
+	}
+
+	memcpy(CG->text + CG->text_length, code, length + 1);
+	CG->text_length += length;
+}
+
+const char *get_reg(const char *from[])
 {
-	for (int i = 0; i < 4; ++i)
+	for (int i = 0; i < POOL_SIZE; ++i)
 	{
-		if (reg_free[i])
+		int id = pool[i];
+		if (CG->reg_free[id])
 		{
-			reg_free[i] = false;
-			REG_ID = i;
-			FROM = NULL;
-			return from[i];
+			CG->reg_free[id] = false;
+			CG->extended[id] = false;
+			CG->reg_id = id;
+			CG->from = NULL;
+			if (id == 1) CG->uses_rbx = true;
+			return from[id];
 		}
 	}
 
+	printf("err :: expression is too complex, ran out of registers.\n");
+	CG->errors++;
 	return NULL;
 }
 
 void free_reg()
 {
-	REG_ID = -1;
-	FROM = NULL;
-	for (int i = 0; i < 4; ++i) reg_free[i] = true;
+	CG->reg_id = -1;
+	CG->from = NULL;
+	for (int i = 0; i < 10; ++i) CG->reg_free[i] = true;
+}
+
+int get_reg_id(const char *reg)
+{
+	if (!reg) return -1;
+
+	for (int i = 0; i < 10; ++i)
+	{
+		if (
+				!strcmp(reg, r64[i]) || !strcmp(reg, r32[i]) ||
+				!strcmp(reg, r16[i]) || !strcmp(reg, r8[i])
+			 ) return i;
+	}
+
+	return -1;
 }
 
 const char *data_type_to_data_directive(data_type_T data_type, bool is_reserved)
@@ -51,15 +111,28 @@ const char *data_type_to_data_directive(data_type_T data_type, bool is_reserved)
 		case di64:
 		case du64:
 		case df64:
+		case dptr:
 		case dstr: 	return is_reserved ? "rq" : "dq";
 		default:
 		{
 			printf("err :: no reserved data directives for this type.\n");
+			CG->errors++;
 			return NULL;
 		}
 	}
 }
 
+const char *data_type_to_size(data_type_T data_type)
+{
+	switch (get_data_type_size(data_type))
+	{
+		case 1: return "byte";
+		case 2: return "word";
+		case 4: return "dword";
+		default: return "qword";
+	}
+}
+
 const char *expr_ast_type_to_symb(ast_type_T type)
 {
 	switch (type)
@@ -68,6 +141,7 @@ const char *expr_ast_type_to_symb(ast_type_T type)
 		case ast_sub: return "-";
 		case ast_mul: return "*";
 		case ast_div: return "/";
+		case ast_mod: return "mod";
 		default: return "";
 	}
 }
@@ -79,11 +153,30 @@ const char *expr_ast_type_to_ins(ast_type_T type)
 		case ast_add: return "add";
 		case ast_sub: return "sub";
 		case ast_mul: return "imul";
-		case ast_div: return "idiv";
 		default: return "";
 	}
 }
 
+// conditional jump (or set) suffix of comparison.
+const char *comparison_to_cc(ast_type_T type, bool is_unsigned)
+{
+	switch (type)
+	{
+		case ast_lt: 	return is_unsigned ? "b" : "l";
+		case ast_lte: return is_unsigned ? "be" : "le";
+		case ast_gt: 	return is_unsigned ? "a" : "g";
+		case ast_gte: return is_unsigned ? "ae" : "ge";
+		case ast_eq: 	return "e";
+		case ast_neq: return "ne";
+		default: return "";
+	}
+}
+
+const char *new_label()
+{
+	return formate_string(".L%ld", CG->label++);
+}
+
 const char **get_reg_list(data_type_T dt)
 {
 	switch (dt)
@@ -99,130 +192,1600 @@ const char **get_reg_list(data_type_T dt)
 		case di64:
 		case du64:
 		case df64:
+		case dptr:
 		case dstr: 	return r64;
 		default: return NULL;
 	}
 }
 
-const char *expr(ast_T *root)
+bool is_assigned(ast_T *root, size_t index)
 {
-	if (root->type == ast_const) return root->token->value;
-	else if (root->type == ast_ident)
+	if (!root) return false;
+	if (root->type == ast_assign && root->index == index) return true;
+
+	return
+		is_assigned(root->left, index) ||
+		is_assigned(root->mid, index) ||
+		is_assigned(root->right, index);
+}
+
+bool is_const_expr(ast_T *root)
+{
+	if (!root) return true;
+	if (root->type == ast_const) return root->data_type != dstr;
+	if (root->type == ast_ident || root->type == ast_call || root->type == ast_alloca) return false;
+
+	return is_const_expr(root->left) && is_const_expr(root->right);
+}
+
+bool is_zero(ast_T *root)
+{
+	if (is_float_data_type(root->data_type))
+		return root->token->value[0] != '-' && strtod(root->token->value, NULL) == 0;
+
+	return strtoll(root->token->value, NULL, 10) == 0;
+}
+
+bool is_defined_function(const char *name)
+{
+	trie_value_T sv = trie_find(symbol_trie_map, name);
+	return sv.is_value && SYMBOLS[sv.value.i32].symb_s == SFUNC;
+}
+
+void add_extern(const char *name)
+{
+	for (size_t i = 0; i < list_length(CG->externs); ++i)
+		if (!strcmp(list_get(CG->externs, i), name))
+			return;
+
+	list_push(CG->externs, (void*)name);
+}
+
+// literal which code uses is remembered, so it is in pool when code is reused.
+const char *use_literal(const char *text, bool needs_length)
+{
+	literal_use_T *literal = malloc(sizeof(literal_use_T));
+	*literal = (literal_use_T){ .text = text, .needs_length = needs_length };
+	list_push(CG->literals, literal);
+
+	const char *label = string_pool_add(text, needs_length);
+	if (label) return label;
+
+	CG->errors++;
+	return "0";
+}
+
+const char *symbol_operand(size_t index)
+{
+	symbol_T symbol = SYMBOLS[index];
+
+	if (symbol.symb_c == CGLOBAL)
+		return formate_string("[%s]", symbol.name);
+
+	// parameter that did not need a slot.
+	if (symbol.is_param && symbol.u64 == 0)
 	{
-		const char *r = get_reg(get_reg_list(root->data_type));
-		section_text =
-			strjoin(section_text, formate_string("\tmov \t%s, [%s]\n", r, root->token->value));
-		return r;
+		if (symbol.arg_stack >= 0)
+			return formate_string("[rbp + %d]", 16 + 8 * symbol.arg_stack);
+
+		if (is_float_data_type(symbol.data_type))
+			return sse_args[symbol.arg_reg];
+
+		return get_reg_list(symbol.data_type)[int_args[symbol.arg_reg]];
+	}
+
+	// leaf functions keep their locals in the red zone.
+	return CG->framed ?
+		formate_string("[rbp - %ld]", symbol.u64) :
+		formate_string("[rsp - %ld]", symbol.u64);
+}
+
+// load value into 64-bit register with sign/zero extension.
+void load_extended(int reg, const char *operand, data_type_T data_type, bool is_const)
+{
+	const char *txt;
+
+	if (is_const)
+	{
+		int64_t value = strtoll(operand, NULL, 10);
+		txt = (value >= 0 && value <= UINT32_MAX) ?
+			formate_string("\tmov \t%s, %s\n", r32[reg], operand) :
+			formate_string("\tmov \t%s, %s\n", r64[reg], operand);
 	}
 	else
 	{
-		if (root->left->type == ast_const && root->right->type == ast_const)
-			return formate_string("%s %s %s", expr(root->left), expr_ast_type_to_symb(root->type), expr(root->right));
+		const char *size = operand[0] == '[' ? data_type_to_size(data_type) : "";
+		const char *space = operand[0] == '[' ? " " : "";
+
+		switch (get_data_type_size(data_type))
+		{
+			case 1:
+			case 2:
+				txt = formate_string("\t%s \t%s, %s%s%s\n",
+						is_signed_data_type(data_type) ? "movsx" : "movzx",
+						is_signed_data_type(data_type) ? r64[reg] : r32[reg],
+						size, space, operand);
+				break;
+			case 4:
+				txt = is_signed_data_type(data_type) ?
+					formate_string("\tmovsxd \t%s, %s%s%s\n", r64[reg], size, space, operand) :
+					formate_string("\tmov \t%s, %s\n", r32[reg], operand);
+				break;
+			default:
+				txt = formate_string("\tmov \t%s, %s\n", r64[reg], operand);
+		}
+	}
+
+	append_text(txt);
+	CG->extended[reg] = true;
+}
+
+const char *expr(ast_T *root);
+ast_type_T compare(ast_T *root, bool *is_unsigned);
+void statement(ast_T *root);
+
+// value in register is converted from one type to another, narrowing is free
+// (lower part of register is used), widening sign or zero extends by source type.
+const char *convert(int id, data_type_T from, data_type_T to)
+{
+	uint8_t from_size = get_data_type_size(from), to_size = get_data_type_size(to);
+
+	if (from_size && from_size < to_size && !CG->extended[id])
+		load_extended(id, get_reg_list(from)[id], from, false);
+
+	return get_reg_list(to)[id];
+}
+
+// integer operations are done in 32 bits (writes zero upper half, no partial
+// register writes) unless they need 64 bits.
+const char **operation_regs(data_type_T data_type)
+{
+	return get_data_type_size(data_type) == 8 ? r64 : r32;
+}
+
+// constant that cannot be an immediate of 64-bit operation.
+bool is_wide_const(ast_T *root, data_type_T data_type)
+{
+	if (root->type != ast_const || get_data_type_size(data_type) != 8) return false;
+
+	int64_t value = strtoll(root->token->value, NULL, 10);
+	return value < INT32_MIN || value > INT32_MAX;
+}
+
+// operand of operation which has type of result (`data_type`), constants stay immediates.
+const char *typed_operand(ast_T *root, data_type_T data_type)
+{
+	bool is_const = root->type == ast_const && root->data_type != dstr;
+	if (is_const && !is_wide_const(root, data_type)) return root->token->value;
+
+	if (is_const)
+	{
+		get_reg(r64);
+		load_extended(CG->reg_id, root->token->value, data_type, true);
+		return r64[CG->reg_id];
+	}
+
+	int id = get_reg_id(expr(root));
+	convert(id, root->data_type, data_type);
+
+	return operation_regs(data_type)[id];
+}
+
+bool is_simple_arg(ast_T *arg)
+{
+	return
+		(arg->type == ast_const && arg->data_type != dstr) ||
+		arg->type == ast_ident;
+}
+
+const char *call(ast_T *root)
+{
+	list_T *args = init_list(sizeof(ast_T *));
+	flatten_join(root->left, args);
+	size_t argc = list_length(args);
+
+	// classify arguments.
+	int8_t *arg_reg = malloc(sizeof(int8_t) * (argc + 1));
+	size_t n_int = 0, n_sse = 0, n_stack = 0;
+	for (size_t i = 0; i < argc; ++i)
+	{
+		ast_T *arg = list_get(args, i);
+		if (is_float_data_type(arg->data_type))
+			arg_reg[i] = n_sse < 8 ? (int8_t)n_sse++ : -1;
 		else
+			arg_reg[i] = n_int < 6 ? (int8_t)n_int++ : -1;
+
+		if (arg_reg[i] < 0) n_stack++;
+	}
+
+	// caller-saved registers that are holding value.
+	int saved[POOL_SIZE];
+	size_t n_saved = 0;
+	for (int i = 0; i < POOL_SIZE; ++i)
+	{
+		int id = pool[i];
+		if (!CG->reg_free[id] && id != 1)
 		{
-			const char *r;
-			if (root->left->type != ast_const)
+			append_text(formate_string("\tpush \t%s\n", r64[id]));
+			CG->push_depth += 8;
+			saved[n_saved++] = id;
+			CG->reg_free[id] = true;
+		}
+	}
+
+	// stack must be aligned to 16 bytes at call, also when it is nested in argument of another call.
+	bool pad = (CG->push_depth / 8 + n_stack) % 2;
+	if (pad) append_text("\tsub \trsp, 8\n");
+	CG->push_depth += 8 * pad;
+
+	// stack arguments are pushed from right to left,
+	// then complex arguments are evaluated and kept on the stack.
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		for (ssize_t i = argc - 1; i >= 0; --i)
+		{
+			ast_T *arg = list_get(args, i);
+			if (pass == 0 && arg_reg[i] >= 0) continue;
+			if (pass == 1 && (arg_reg[i] < 0 || is_simple_arg(arg))) continue;
+
+			if (is_float_data_type(arg->data_type) && !is_simple_arg(arg))
+			{
+				printf("err :: float expressions are not supported yet.\n");
+				CG->errors++;
+				continue;
+			}
+
+			if (arg->type == ast_ident && !is_float_data_type(arg->data_type))
 			{
-				r = expr(root->left);
-				const char *s1 = formate_string("\t%s \t%s, %s\n",
-					expr_ast_type_to_ins(root->type),
-					r, expr(root->right)
-				);
-				section_text = strjoin(section_text, s1);
+				load_extended(0, symbol_operand(arg->index), arg->data_type, false);
+				append_text("\tpush \trax\n");
+				CG->push_depth += 8;
+				continue;
 			}
+
+			const char *v = expr(arg);
+			if (arg->type == ast_const && arg->data_type != dstr)
+				append_text(formate_string("\tpush \t%s\n", v));
+			else if (arg->type == ast_ident)
+				append_text(formate_string("\tpush \tqword %s\n", v));
 			else
 			{
-				r = expr(root->right);
-				const char *s1 = formate_string("\t%s \t%s, %s\n",
-					expr_ast_type_to_ins(root->type),
-					r, expr(root->left)
-				);
-				section_text = strjoin(section_text, s1);
+				int id = get_reg_id(v);
+				convert(id, arg->data_type, di64);
+				append_text(formate_string("\tpush \t%s\n", r64[id]));
+				CG->reg_free[id] = true;
+			}
+			CG->push_depth += 8;
+		}
+	}
+
+	for (size_t i = 0; i < argc; ++i)
+	{
+		ast_T *arg = list_get(args, i);
+		if (arg_reg[i] >= 0 && !is_simple_arg(arg) && !is_float_data_type(arg->data_type))
+		{
+			append_text(formate_string("\tpop \t%s\n", r64[int_args[arg_reg[i]]]));
+			CG->push_depth -= 8;
+		}
+	}
+
+	// simple arguments go straight into their registers.
+	for (size_t i = 0; i < argc; ++i)
+	{
+		ast_T *arg = list_get(args, i);
+		if (arg_reg[i] < 0 || !is_simple_arg(arg)) continue;
+
+		if (is_float_data_type(arg->data_type))
+		{
+			if (arg->type == ast_const)
+			{
+				printf("err :: float constants are not supported yet.\n");
+				CG->errors++;
+				continue;
 			}
 
-			return r;
+			append_text(formate_string("\t%s \t%s, %s\n",
+				arg->data_type == df32 ? "movss" : "movsd",
+				sse_args[arg_reg[i]], symbol_operand(arg->index)));
 		}
+		else if (arg->type == ast_const)
+			load_extended(int_args[arg_reg[i]], arg->token->value, arg->data_type, true);
+		else
+			load_extended(int_args[arg_reg[i]], symbol_operand(arg->index), arg->data_type, false);
+	}
+
+	// variadic functions need upper bound of vector registers used in al.
+	const char *name = root->token->value;
+	if (!is_defined_function(name))
+	{
+		name = builtin_symbol(name);
+		add_extern(name);
+		append_text(formate_string("\tmov \teax, %ld\n", n_sse));
+	}
+
+	append_text(formate_string("\tcall \t%s\n", name));
+
+	if (n_stack || pad)
+		append_text(formate_string("\tadd \trsp, %ld\n", 8 * (n_stack + pad)));
+	CG->push_depth -= 8 * (n_stack + pad);
+
+	for (size_t i = 0; i < n_saved; ++i)
+		CG->reg_free[saved[i]] = false;
+
+	const char *r = "";
+	if (root->data_type != dvoid)
+	{
+		r = get_reg(get_reg_list(root->data_type));
+		if (CG->reg_id != 0)
+			append_text(formate_string("\tmov \t%s, rax\n", r64[CG->reg_id]));
 	}
+
+	int result = CG->reg_id;
+	for (ssize_t i = n_saved - 1; i >= 0; --i)
+		append_text(formate_string("\tpop \t%s\n", r64[saved[i]]));
+	CG->push_depth -= 8 * n_saved;
+	CG->reg_id = result;
+
+	free(arg_reg);
+	list_free(args);
+
+	return r;
 }
 
-void assign(ast_T *root)
+// address of `$(p, i)` element, register of pointer stays allocated.
+const char *element(ast_T *root)
 {
-	const char *s1;
-	if (root->left->type != ast_const)
-	{
-		s1 = formate_string("%s %s 0\n",
-			root->token->value,
-			data_type_to_data_directive(root->data_type, false)
-		);
+	expr(root->left);
+	int base = CG->reg_id;
 
-		const char *r = expr(root->left);
-		uint8_t lhs = get_data_type_size(root->data_type),
-						rhs = get_data_type_size(root->left->data_type);
-		const char *txt = formate_string("\tmov \t[%s], %s\n",
-			root->token->value,
-			(lhs > 0 && rhs > 0) ?
-				get_reg_list(root->data_type)[REG_ID] :
-				r
-		);
+	if (root->right->type == ast_const)
+		return formate_string("[%s + %ld]", r64[base], 8 * strtoll(root->right->token->value, NULL, 10));
 
-		section_text = strjoin(section_text, txt);
+	const char *r = expr(root->right);
+	int index = get_reg_id(r);
+	if (get_data_type_size(root->right->data_type) < 8)
+		load_extended(index, r, root->right->data_type, false);
+
+	CG->reg_free[index] = true;
+	CG->reg_id = base;
+
+	return formate_string("[%s + %s*8]", r64[base], r64[index]);
+}
+
+void store(ast_T *root)
+{
+	ast_T *value = root->right;
+	const char *v;
+
+	if (value->type == ast_const)
+	{
+		int64_t c = strtoll(value->token->value, NULL, 10);
+		if (c >= INT32_MIN && c <= INT32_MAX)
+			v = value->token->value;
+		else
+		{
+			v = get_reg(r64);
+			append_text(formate_string("\tmov \t%s, %s\n", v, value->token->value));
+		}
 	}
 	else
 	{
-		s1 = formate_string("%s %s %s\n",
-			root->token->value,
-			data_type_to_data_directive(root->data_type, false),
-			root->left->token->value
-		);
+		int id = get_reg_id(expr(value));
+		if (get_data_type_size(value->data_type) < 8)
+			load_extended(id, get_reg_list(value->data_type)[id], value->data_type, false);
+		v = r64[id];
 	}
 
-	section_data = strjoin(section_data, s1);
+	append_text(formate_string("\tmov \tqword %s, %s\n", element(root->left), v));
 	free_reg();
 }
 
-void at_asm(ast_T *root)
+// moves values out of rax, so it can be clobbered by mul/div.
+// registers in rax are renamed, returns register holding other live value of rax (or -1).
+int claim_rax(int *a, int *b)
 {
-	section_text = strjoin(section_text, 
-		formate_string("\t%s\n", root->token->value)
-	);
+	if (CG->reg_free[0]) return -1;
+
+	get_reg(r64);
+	int t = CG->reg_id, saved = -1;
+	append_text(formate_string("\tmov \t%s, rax\n", r64[t]));
+
+	if (*a == 0) *a = t;
+	else if (b && *b == 0) *b = t;
+	else saved = t;
+
+	CG->reg_free[0] = true;
+	return saved;
 }
 
-void statement(ast_T *root)
+void release_rax(int saved)
 {
-	switch (root->type)
+	if (saved < 0) return;
+
+	append_text(formate_string("\tmov \trax, %s\n", r64[saved]));
+	CG->reg_free[saved] = true;
+	CG->reg_free[0] = false;
+}
+
+// operand of division, extended to 64-bit register.
+int division_operand(ast_T *operand)
+{
+	const char *r;
+	if (operand->type == ast_const)
 	{
-		case ast_join:
-			statement(root->left);
-			statement(root->right);
-			break;
+		r = get_reg(r64);
+		load_extended(CG->reg_id, operand->token->value, operand->data_type, true);
+	}
+	else r = expr(operand);
 
-		case ast_assign:
-			assign(root);
-			break;
+	int id = get_reg_id(r);
+	if (operand->type != ast_const && get_data_type_size(operand->data_type) < 8 && !CG->extended[id])
+		load_extended(id, r, operand->data_type, false);
 
-		case ast_at_asm:
-			at_asm(root);
-			break;
+	return id;
+}
 
-		default:
-			break;
+// x / d and x % d with hardware division, rdx is clobbered.
+int hardware_divide(ast_T *root, bool is_signed, uint8_t size)
+{
+	const char **regs = size == 8 ? r64 : r32;
+
+	int x = division_operand(root->left);
+	int d = division_operand(root->right);
+
+	// dividend is put into rax, other value of rax is swapped
+	// into register of dividend and swapped back afterwards.
+	bool swapped = x != 0 && d != 0 && !CG->reg_free[0];
+	if (d == 0)
+	{
+		append_text(formate_string("\txchg \trax, %s\n", r64[x]));
+		d = x;
+		x = 0;
+	}
+	else if (x != 0)
+		append_text(formate_string("\t%s \trax, %s\n",
+			swapped ? "xchg" : "mov", r64[x]));
+
+	append_text(formate_string("\t%s\n\t%s \t%s\n",
+		is_signed ? (size == 8 ? "cqo" : "cdq") : "xor \tedx, edx",
+		is_signed ? "idiv" : "div", regs[d]));
+
+	const char *result = root->type == ast_div ? regs[0] : regs[3];
+	if (swapped && root->type == ast_div)
+		append_text(formate_string("\txchg \trax, %s\n", r64[x]));
+	else if (swapped)
+		append_text(formate_string("\tmov \trax, %s\n\tmov \t%s, %s\n",
+			r64[x], regs[x], result));
+	else if (strcmp(regs[x], result))
+		append_text(formate_string("\tmov \t%s, %s\n", regs[x], result));
+
+	CG->reg_free[d] = true;
+	CG->reg_free[x] = false;
+
+	return x;
+}
+
+static bool is_power_of_two(uint64_t v)
+{
+	return v && !(v & (v - 1));
+}
+
+// x / d and x % d for constant d, rdx is clobbered (and rax for 64-bit magic).
+// magic numbers are those of Granlund and Montgomery,
+// "Division by Invariant Integers using Multiplication" (1994).
+int constant_divide(ast_T *root, bool is_signed, uint8_t size, int64_t d)
+{
+	const char **regs = size == 8 ? r64 : r32;
+	const char *dx = regs[3];
+	uint8_t bits = 8 * size;
+	uint64_t abs_d = d < 0 ? -(uint64_t)d : (uint64_t)d;
+	bool is_div = root->type == ast_div;
+
+	int x = division_operand(root->left);
+	const char *rx = regs[x];
+
+	if (abs_d == 1)
+	{
+		append_text(!is_div ?
+			formate_string("\txor \t%s, %s\n", r32[x], r32[x]) :
+			d < 0 ? formate_string("\tneg \t%s\n", rx) : "");
+		return x;
+	}
+
+	uint8_t l = 64 - __builtin_clzll(abs_d - 1);
+
+	if (!is_signed && is_power_of_two(abs_d))
+	{
+		append_text(is_div ?
+			formate_string("\tshr \t%s, %d\n", rx, l) :
+			formate_string("\tand \t%s, %ld\n", rx, abs_d - 1));
+		return x;
+	}
+
+	// quotient of |d| is computed into rdx.
+	const char *txt;
+	if (is_power_of_two(abs_d))
+		// negative x is biased by d - 1, so quotient rounds toward zero.
+		txt = formate_string("\tmov \t%s, %s\n\tsar \t%s, %d\n\tshr \t%s, %d\n\tadd \t%s, %s\n\tsar \t%s, %d\n",
+			dx, rx, dx, bits - 1, dx, bits - l, dx, rx, dx, l);
+	else if (!is_signed)
+	{
+		unsigned __int128 m = (((unsigned __int128)1 << (bits + l)) + abs_d - 1) / abs_d;
+		uint64_t magic = (uint64_t)(m - ((unsigned __int128)1 << bits));
+
+		if (size < 8)
+			txt = formate_string("\tmov \tedx, %lu\n\timul \trdx, %s\n\tshr \trdx, 32\n\tadd \trdx, %s\n\tshr \trdx, %d\n",
+				magic, r64[x], r64[x], l);
+		else
+		{
+			int saved = claim_rax(&x, NULL);
+			rx = regs[x];
+
+			txt = formate_string(
+				"\tmov \trax, %lu\n\tmul \t%s\n\tmov \trax, %s\n\tsub \trax, rdx\n"
+				"\tshr \trax, 1\n\tadd \trax, rdx\n\tshr \trax, %d\n\tmov \trdx, rax\n",
+				magic, rx, rx, l - 1);
+			append_text(txt);
+			release_rax(saved);
+			txt = "";
+		}
+	}
+	else
+	{
+		unsigned __int128 m = ((unsigned __int128)1 << (bits + l - 1)) / abs_d + 1;
+		int64_t magic = (int64_t)(uint64_t)(m - ((unsigned __int128)1 << bits));
+		if (size < 8) magic = (int32_t)magic;
+
+		if (size < 8)
+			txt = formate_string("\timul \trdx, %s, %ld\n\tsar \trdx, 32\n\tadd \tedx, %s\n",
+				r64[x], magic, rx);
+		else
+		{
+			int saved = claim_rax(&x, NULL);
+			rx = regs[x];
+
+			append_text(formate_string(
+				"\tmov \trax, %ld\n\timul \t%s\n\tadd \trdx, %s\n", magic, rx, rx));
+			release_rax(saved);
+			txt = "";
+		}
+
+		if (l > 1) txt = strjoin(txt, formate_string("\tsar \t%s, %d\n", dx, l - 1));
+		// negative x rounds toward zero.
+		txt = strjoin(txt, formate_string("\tbt \t%s, %d\n\tadc \t%s, 0\n", rx, bits - 1, dx));
+	}
+	append_text(txt);
+
+	if (is_div)
+		append_text(formate_string("%s\tmov \t%s, %s\n",
+			d < 0 ? formate_string("\tneg \t%s\n", dx) : "", rx, dx));
+	else
+		append_text(formate_string("\timul \t%s, %s, %ld\n\tsub \t%s, %s\n",
+			dx, dx, abs_d, rx, dx));
+
+	return x;
+}
+
+// division and modulo are done in 32 or 64 bits, signed unless type is unsigned.
+const char *divide(ast_T *root)
+{
+	bool is_signed = root->data_type == dnil || is_signed_data_type(root->data_type);
+	uint8_t size = get_data_type_size(root->data_type) == 8 ? 8 : 4;
+
+	int x;
+	int64_t d = root->right->type == ast_const ? strtoll(root->right->token->value, NULL, 10) : 0;
+	if (d != 0 && d >= -INT32_MAX && d <= INT32_MAX && (is_signed || d > 0))
+		x = constant_divide(root, is_signed, size, d);
+	else
+		x = hardware_divide(root, is_signed, size);
+
+	CG->reg_id = x;
+	return get_reg_list(root->data_type)[x];
+}
+
+// arm of select in register of its type, constants are loaded too.
+static int select_arm(ast_T *arm, data_type_T data_type)
+{
+	if (arm->type == ast_const && arm->data_type != dstr)
+	{
+		get_reg(r64);
+		load_extended(CG->reg_id, arm->token->value, data_type, true);
+		return CG->reg_id;
 	}
+
+	// value of other type is extended by its own type, not by type of select.
+	int id = get_reg_id(typed_operand(arm, data_type));
+	if (arm->data_type != data_type) CG->extended[id] = false;
+
+	return id;
 }
 
-void init_asmgen(const char *output, ast_T *root)
+// `c ? a : b` jumps over arm which is not taken, both arms end in same register.
+// registers which hold values of outer expression are kept, unlike in `condition`.
+const char *select_value(ast_T *root)
 {
-	if (!output) return;
+	const char *else_label = new_label(), *end_label = new_label();
+	ast_T *cond = root->left;
 
-	OUTPUT = fopen(output, "w");
+	if (is_comparison(cond->type))
+	{
+		bool is_unsigned;
+		ast_type_T type = comparison_inverse(compare(cond, &is_unsigned));
+		CG->reg_free[CG->reg_id] = true;
+		append_text(formate_string("\tj%s \t%s\n", comparison_to_cc(type, is_unsigned), else_label));
+	}
+	else if (cond->type == ast_const)
+	{
+		if (!strtoll(cond->token->value, NULL, 10))
+			append_text(formate_string("\tjmp \t%s\n", else_label));
+	}
+	else
+	{
+		const char *r = expr(cond);
+		if (get_reg_id(r) >= 0) CG->reg_free[get_reg_id(r)] = true;
+		append_text(formate_string("\ttest \t%s, %s\n\tjz \t%s\n", r, r, else_label));
+	}
 
-	section_text = formate_string(
-		"section '.text' executable\n"
-		"extrn putchar\n"
-		"extrn exit\n"
-		"public _start\n"
-		"_start:\n"
-	);
-	section_data = formate_string("section '.data' writeable\n");
-	statement(root);
-	fprintf(OUTPUT,"format ELF64\n%s%s", section_text, section_data);
+	bool reg_free[10];
+	memcpy(reg_free, CG->reg_free, sizeof(reg_free));
+
+	int id = select_arm(root->mid, root->data_type);
+	bool extended = CG->extended[id];
+	append_text(formate_string("\tjmp \t%s\n%s:\n", end_label, else_label));
+
+	memcpy(CG->reg_free, reg_free, sizeof(reg_free));
+	int other = select_arm(root->right, root->data_type);
+	extended = extended && CG->extended[other];
+	if (other != id)
+		append_text(formate_string("\tmov \t%s, %s\n", r64[id], r64[other]));
+	append_text(formate_string("%s:\n", end_label));
+
+	memcpy(CG->reg_free, reg_free, sizeof(reg_free));
+	CG->reg_free[id] = false;
+	CG->extended[id] = extended;
+	CG->reg_id = id;
+	CG->from = NULL;
+
+	return get_reg_list(root->data_type)[id];
+}
+
+const char *expr(ast_T *root)
+{
+	if (root->type == ast_const && root->data_type == dstr)
+	{
+		const char *r = get_reg(r64);
+		append_text(formate_string("\tlea \t%s, [%s]\n", r, use_literal(root->token->value, true)));
+		return r;
+	}
+	else if (root->type == ast_const) return root->token->value;
+	else if (root->type == ast_call) return call(root);
+	else if (root->type == ast_select) return select_value(root);
+	else if (root->type == ast_alloca)
+	{
+		const char *r = get_reg(r64);
+		append_text(formate_string("\tlea \t%s, %s\n", r, symbol_operand(root->index)));
+		return r;
+	}
+	else if (root->type == ast_deref)
+	{
+		const char *address = element(root);
+		int id = CG->reg_id;
+		append_text(formate_string("\tmov \t%s, qword %s\n", r64[id], address));
+		CG->reg_id = id;
+		return r64[id];
+	}
+	else if (root->type == ast_ident)
+	{
+		if (is_float_data_type(root->data_type))
+		{
+			printf("err :: float expressions are not supported yet.\n");
+			CG->errors++;
+		}
+
+		// narrow values are loaded extended, so they do not write part of register.
+		const char *r = get_reg(get_reg_list(root->data_type));
+		if (get_data_type_size(root->data_type) < 4)
+			load_extended(CG->reg_id, symbol_operand(root->index), root->data_type, false);
+		else
+			append_text(formate_string("\tmov \t%s, %s\n", r, symbol_operand(root->index)));
+		return r;
+	}
+	else if (is_comparison(root->type))
+	{
+		// comparison as value is 0 or 1.
+		bool is_unsigned;
+		ast_type_T type = compare(root, &is_unsigned);
+		int id = CG->reg_id;
+
+		append_text(formate_string("\tset%s \t%s\n\tmovzx \t%s, %s\n",
+			comparison_to_cc(type, is_unsigned), r8[id], r32[id], r8[id]));
+
+		CG->reg_id = id;
+		return r32[id];
+	}
+	else
+	{
+		if (root->left->type == ast_const && root->right->type == ast_const)
+			return formate_string("%s %s %s", expr(root->left), expr_ast_type_to_symb(root->type), expr(root->right));
+		else if (root->type == ast_div || root->type == ast_mod)
+			return divide(root);
+		else
+		{
+			// operands are widened to type of result, operands of same
+			// width as result are not extended (only lower bits matter).
+			data_type_T data_type = root->data_type;
+			const char *r, *o;
+			if (root->left->type != ast_const || is_wide_const(root->left, data_type))
+			{
+				r = typed_operand(root->left, data_type);
+				o = typed_operand(root->right, data_type);
+			}
+			else if (root->type == ast_sub)
+			{
+				// operands cannot be swapped, so constant goes into register.
+				r = get_reg(operation_regs(data_type));
+				append_text(formate_string("\tmov \t%s, %s\n", r, root->left->token->value));
+				o = typed_operand(root->right, data_type);
+			}
+			else
+			{
+				r = typed_operand(root->right, data_type);
+				o = root->left->token->value;
+			}
+
+			append_text(formate_string("\t%s \t%s, %s\n",
+				expr_ast_type_to_ins(root->type), r, o));
+
+			// operand register can be reused.
+			if (get_reg_id(o) >= 0) CG->reg_free[get_reg_id(o)] = true;
+
+			int id = get_reg_id(r);
+			CG->extended[id] = get_data_type_size(data_type) == 8;
+			CG->reg_id = id;
+			return get_reg_list(data_type)[id];
+		}
+	}
+}
+
+// emit cmp of both operands, returns comparison that holds after operands were swapped.
+ast_type_T compare(ast_T *root, bool *is_unsigned)
+{
+	data_type_T data_type = type_check(ast_add, root->left->data_type, root->right->data_type);
+	*is_unsigned = data_type != dnil && !is_signed_data_type(data_type);
+
+	// operands are compared in their wider type, extended by their own signedness.
+	if (data_type == dnil) data_type = di64;
+
+	ast_type_T type = root->type;
+	const char *r, *o;
+
+	if (root->left->type != ast_const || is_wide_const(root->left, data_type))
+	{
+		r = typed_operand(root->left, data_type);
+		o = typed_operand(root->right, data_type);
+	}
+	else if (root->right->type != ast_const)
+	{
+		r = typed_operand(root->right, data_type);
+		o = root->left->token->value;
+		type = comparison_mirror(type);
+	}
+	else
+	{
+		r = get_reg(operation_regs(data_type));
+		load_extended(CG->reg_id, root->left->token->value, data_type, true);
+		o = typed_operand(root->right, data_type);
+	}
+
+	append_text(formate_string("\tcmp \t%s, %s\n", r, o));
+
+	if (get_reg_id(o) >= 0) CG->reg_free[get_reg_id(o)] = true;
+	CG->reg_id = get_reg_id(r);
+
+	return type;
+}
+
+// jump to label when condition is equal to `when`.
+void condition(ast_T *root, const char *label, bool when)
+{
+	if (is_comparison(root->type))
+	{
+		bool is_unsigned;
+		ast_type_T type = compare(root, &is_unsigned);
+		if (!when) type = comparison_inverse(type);
+
+		append_text(formate_string("\tj%s \t%s\n", comparison_to_cc(type, is_unsigned), label));
+	}
+	else if (root->type == ast_const)
+	{
+		bool value = strtoll(root->token->value, NULL, 10) != 0;
+		if (value == when)
+			append_text(formate_string("\tjmp \t%s\n", label));
+	}
+	else
+	{
+		const char *r = expr(root);
+		append_text(formate_string("\ttest \t%s, %s\n\tj%s \t%s\n",
+			r, r, when ? "nz" : "z", label));
+	}
+
+	free_reg();
+}
+
+void if_statement(ast_T *root)
+{
+	const char *else_label = new_label();
+	const char *end_label = root->right ? new_label() : else_label;
+
+	condition(root->left, else_label, false);
+	statement(root->mid);
+
+	if (root->right)
+	{
+		append_text(formate_string("\tjmp \t%s\n%s:\n", end_label, else_label));
+		statement(root->right);
+	}
+
+	append_text(formate_string("%s:\n", end_label));
+}
+
+// condition is checked at the bottom, so each iteration takes one jump.
+void while_statement(ast_T *root)
+{
+	const char *body_label = new_label();
+	const char *cond_label = new_label();
+
+	append_text(formate_string("\tjmp \t%s\n%s:\n", cond_label, body_label));
+	statement(root->mid);
+	append_text(formate_string("%s:\n", cond_label));
+	condition(root->left, body_label, true);
+}
+
+void assign(ast_T *root)
+{
+	symbol_T symbol = SYMBOLS[root->index];
+
+	// locals live in stack frame (or in the red zone).
+	if (symbol.symb_c == CLOCAL || data_defined[root->index])
+	{
+		if (!root->left || symbol.is_const) return;
+
+		const char *operand = symbol_operand(root->index);
+		const char *txt;
+
+		if (is_const_expr(root->left) && !is_wide_const(root->left, symbol.data_type))
+			txt = formate_string("\tmov \t%s %s, %s\n",
+				data_type_to_size(symbol.data_type), operand, expr(root->left));
+		else
+		{
+			const char *r = typed_operand(root->left, symbol.data_type);
+			txt = formate_string("\tmov \t%s, %s\n",
+				operand, get_reg_list(symbol.data_type)[get_reg_id(r)]);
+		}
+
+		append_text(txt);
+		free_reg();
+		return;
+	}
+
+	data_defined[root->index] = true;
+
+	global_T *global = malloc(sizeof(global_T));
+	*global = (global_T){
+		.name = root->token->value,
+		.data_type = root->data_type,
+		.value = NULL,
+		.is_const = symbol.is_const,
+		.weight = global_weight[root->index]
+	};
+	list_push(globals, global);
+
+	if (!root->left) return;
+	else if (root->left->type == ast_const && root->left->data_type == dstr)
+		global->value = use_literal(root->left->token->value, true);
+	else if (!is_const_expr(root->left))
+	{
+		const char *r = typed_operand(root->left, root->data_type);
+		append_text(formate_string("\tmov \t[%s], %s\n",
+			root->token->value, get_reg_list(root->data_type)[get_reg_id(r)]));
+	}
+	else if (root->left->type != ast_const || !is_zero(root->left))
+		global->value = expr(root->left);
+
+	free_reg();
+}
+
+// uses of globals, each loop around use makes it GLOBAL_LOOP_WEIGHT times heavier.
+void weigh_globals(ast_T *root, uint64_t depth)
+{
+	if (!root) return;
+
+	if ((root->type == ast_ident || root->type == ast_assign) &&
+			SYMBOLS[root->index].symb_s == SVAR && SYMBOLS[root->index].symb_c == CGLOBAL)
+	{
+		uint64_t weight = 1;
+		for (uint64_t i = 0; i < depth && i < GLOBAL_MAX_DEPTH; ++i) weight *= GLOBAL_LOOP_WEIGHT;
+		global_weight[root->index] += weight;
+	}
+
+	bool loop = root->type == ast_while || root->type == ast_at_bench;
+	uint64_t inner = depth + loop;
+	weigh_globals(root->left, inner);
+	weigh_globals(root->mid, inner);
+	weigh_globals(root->right, loop ? inner : depth);
+}
+
+static int compare_globals(const void *a, const void *b)
+{
+	global_T *x = *(global_T **)a, *y = *(global_T **)b;
+
+	bool hot_x = x->weight >= GLOBAL_HOT_WEIGHT, hot_y = y->weight >= GLOBAL_HOT_WEIGHT;
+	if (hot_x != hot_y) return hot_y - hot_x;
+
+	// larger first, so natural alignment needs no padding
+	uint8_t size_x = get_data_type_size(x->data_type), size_y = get_data_type_size(y->data_type);
+	return (size_x < size_y) - (size_x > size_y);
+}
+
+// zero or uninitialized globals go to .bss, others to .data (or .rodata if const).
+// hot globals are put together before cold ones, and the cold ones
+// start on new cache line.
+void layout_globals()
+{
+	size_t length = list_length(globals);
+	global_T **sorted = malloc(length * sizeof(global_T *));
+	for (size_t i = 0; i < length; ++i) sorted[i] = list_get(globals, i);
+	qsort(sorted, length, sizeof(global_T *), compare_globals);
+
+	section_data = formate_string("section '.data' writeable align %d\n", GLOBAL_CACHE_LINE);
+	section_bss = formate_string("section '.bss' writeable align %d\n", GLOBAL_CACHE_LINE);
+
+	bool data_hot = false, bss_hot = false;
+	for (size_t i = 0; i < length; ++i)
+	{
+		global_T *global = sorted[i];
+		uint8_t size = get_data_type_size(global->data_type);
+		bool hot = global->weight >= GLOBAL_HOT_WEIGHT;
+
+		if (global->is_const)
+			section_rodata = strjoin(section_rodata, formate_string("align %d\n%s %s %s\n",
+				size, global->name, data_type_to_data_directive(global->data_type, false),
+				global->value ? global->value : "0"));
+		else if (global->value)
+		{
+			if (data_hot && !hot)
+				section_data = strjoin(section_data, formate_string("align %d\n", GLOBAL_CACHE_LINE));
+			data_hot = hot;
+
+			section_data = strjoin(section_data, formate_string("align %d\n%s %s %s\n",
+				size, global->name, data_type_to_data_directive(global->data_type, false), global->value));
+		}
+		else
+		{
+			if (bss_hot && !hot)
+				section_bss = strjoin(section_bss, formate_string("align %d\n", GLOBAL_CACHE_LINE));
+			bss_hot = hot;
+
+			section_bss = strjoin(section_bss, formate_string("align %d\n%s %s 1\n",
+				size, global->name, data_type_to_data_directive(global->data_type, true)));
+		}
+	}
+
+	free(sorted);
+}
+
+void at_asm(ast_T *root)
+{
+	append_text(formate_string("\t%s\n", root->token->value));
+}
+
+void ret(ast_T *root)
+{
+	if (root->left)
+	{
+		data_type_T data_type = root->data_type;
+		const char *r = expr(root->left);
+
+		if (data_type == dvoid)
+		{
+			printf("err :: function `%s` does not return a value.\n", CG->function->token->value);
+			CG->errors++;
+		}
+		else if (is_float_data_type(data_type))
+		{
+			printf("err :: float return values are not supported yet.\n");
+			CG->errors++;
+		}
+		else if (is_const_expr(root->left))
+			append_text(formate_string("\tmov \t%s, %s\n", operation_regs(data_type)[0], r));
+		else
+		{
+			convert(CG->reg_id, root->left->data_type, data_type);
+			if (CG->reg_id != 0)
+				append_text(formate_string("\tmov \t%s, %s\n",
+					operation_regs(data_type)[0], operation_regs(data_type)[CG->reg_id]));
+		}
+	}
+
+	// regions which are left by return are closed, return value is kept on stack.
+	// benchmarks which are left by return are dropped without report.
+	if (CG->region_depth || CG->bench_depth)
+	{
+		append_text("\tpush \trax\n\tsub \trsp, 8\n");
+		CG->push_depth += 16;
+		for (uint64_t i = 0; i < CG->region_depth; ++i)
+			append_text("\tcall \ttl_region_end\n");
+		for (uint64_t i = 0; i < CG->bench_depth; ++i)
+			append_text("\tcall \ttl_bench_cancel\n");
+		append_text("\tadd \trsp, 8\n\tpop \trax\n");
+		CG->push_depth -= 16;
+	}
+
+	append_text("\tjmp \t.ret\n");
+	free_reg();
+}
+
+void region(ast_T *root)
+{
+	add_extern("tl_region_begin");
+	add_extern("tl_region_end");
+
+	append_text("\tcall \ttl_region_begin\n");
+
+	CG->region_depth++;
+	statement(root->left);
+	CG->region_depth--;
+
+	append_text("\tcall \ttl_region_end\n");
+}
+
+// runtime times each iteration, `tl_bench_next` returns 0 once all of them ran
+// and report with median and p99 is printed.
+void bench(ast_T *root)
+{
+	add_extern("tl_bench_begin");
+	add_extern("tl_bench_next");
+	add_extern("tl_bench_cancel");
+
+	const char *next_label = new_label();
+	const char *end_label = new_label();
+
+	append_text(formate_string(
+		"\tlea \trdi, [%s]\n\tmov \trsi, %lu\n\tcall \ttl_bench_begin\n"
+		"%s:\n\tcall \ttl_bench_next\n\ttest \teax, eax\n\tjz \t%s\n",
+		use_literal(root->token->value, false), root->index, next_label, end_label));
+
+	CG->bench_depth++;
+	statement(root->left);
+	CG->bench_depth--;
+
+	append_text(formate_string("\tjmp \t%s\n%s:\n", next_label, end_label));
+}
+
+uint64_t allocate_slot(size_t index)
+{
+	uint8_t size = get_data_type_size(SYMBOLS[index].data_type);
+	if (size == 0) size = 8;
+
+	CG->frame_size += size;
+	CG->frame_size = (CG->frame_size + size - 1) / size * size;
+	SYMBOLS[index].u64 = CG->frame_size;
+
+	return CG->frame_size;
+}
+
+// buffer of allocation which does not escape the function.
+void allocate_buffer(size_t index, uint64_t size)
+{
+	CG->frame_size = (CG->frame_size + size + 15) / 16 * 16;
+	SYMBOLS[index].u64 = CG->frame_size;
+}
+
+void allocate_locals(ast_T *root)
+{
+	if (!root) return;
+
+	if (root->type == ast_alloca && SYMBOLS[root->index].u64 == 0)
+		allocate_buffer(root->index, strtoll(root->left->token->value, NULL, 10));
+
+	if (
+			root->type == ast_assign &&
+			SYMBOLS[root->index].symb_c == CLOCAL &&
+			!SYMBOLS[root->index].is_const &&
+			SYMBOLS[root->index].u64 == 0
+		 ) allocate_slot(root->index);
+
+	allocate_locals(root->left);
+	allocate_locals(root->mid);
+	allocate_locals(root->right);
+}
+
+// runs in context of its own, text of function replaces text of context.
+void function(ast_T *root)
+{
+	CG->function = root;
+	CG->frame_size = 0;
+	CG->uses_rbx = false;
+
+	list_T *params = init_list(sizeof(ast_T *));
+	flatten_join(root->mid, params);
+
+	// leaf functions does not need frame pointer,
+	// their locals are kept below stack pointer (red zone).
+	CG->framed =
+		ast_contains(root->left, ast_call) ||
+		ast_contains(root->left, ast_region) ||
+		ast_contains(root->left, ast_at_bench);
+	for (size_t i = 0; i < list_length(params); ++i)
+	{
+		ast_T *param = list_get(params, i);
+		if (SYMBOLS[param->index].arg_stack >= 0) CG->framed = true;
+	}
+
+	// parameters stay in their registers, unless they are assigned
+	// or function calls another function (argument registers are clobbered).
+	// division clobbers rdx, which holds third integer parameter.
+	bool divides = ast_contains(root->left, ast_div) || ast_contains(root->left, ast_mod);
+	for (size_t i = 0; i < list_length(params); ++i)
+	{
+		ast_T *param = list_get(params, i);
+		symbol_T symbol = SYMBOLS[param->index];
+		bool in_rdx = !is_float_data_type(symbol.data_type) && symbol.arg_reg == 2;
+
+		if (symbol.arg_stack >= 0 && !is_assigned(root->left, param->index)) continue;
+		if (CG->framed || is_assigned(root->left, param->index) || (divides && in_rdx))
+			allocate_slot(param->index);
+	}
+
+	allocate_locals(root->left);
+	if (CG->frame_size > 128) CG->framed = true;
+
+	statement(root->left);
+	char *body = CG->text;
+
+	// return at the end of body falls through into epilogue.
+	size_t body_len = strlen(body), jmp_len = strlen("\tjmp \t.ret\n");
+	if (body_len >= jmp_len && !strcmp(body + body_len - jmp_len, "\tjmp \t.ret\n"))
+		body[body_len - jmp_len] = '\0';
+
+	char *prologue = formate_string("%s:\n", root->token->value);
+	char *epilogue = ".ret:\n";
+
+	if (CG->framed)
+	{
+		uint64_t rbx_slot = CG->uses_rbx ? (CG->frame_size += 8) : 0;
+		uint64_t size = (CG->frame_size + 15) / 16 * 16;
+
+		prologue = strjoin(prologue, "\tpush \trbp\n\tmov \trbp, rsp\n");
+		if (size)
+			prologue = strjoin(prologue, formate_string("\tsub \trsp, %ld\n", size));
+		if (rbx_slot)
+		{
+			prologue = strjoin(prologue, formate_string("\tmov \t[rbp - %ld], rbx\n", rbx_slot));
+			epilogue = strjoin(epilogue, formate_string("\tmov \trbx, [rbp - %ld]\n", rbx_slot));
+		}
+		epilogue = strjoin(epilogue, "\tleave\n");
+	}
+	else if (CG->uses_rbx)
+	{
+		prologue = strjoin(prologue, "\tpush \trbx\n");
+		epilogue = strjoin(epilogue, "\tpop \trbx\n");
+	}
+
+	epilogue = strjoin(epilogue, "\tret\n");
+
+	// spill parameters which needs a slot.
+	for (size_t i = 0; i < list_length(params); ++i)
+	{
+		ast_T *param = list_get(params, i);
+		symbol_T symbol = SYMBOLS[param->index];
+		if (symbol.u64 == 0) continue;
+
+		const char *slot = symbol_operand(param->index);
+		const char *txt;
+
+		if (symbol.arg_stack >= 0)
+			txt = formate_string("\tmov \trax, [rbp + %d]\n\tmov \t%s, %s\n",
+				16 + 8 * symbol.arg_stack, slot, get_reg_list(symbol.data_type)[0]);
+		else if (is_float_data_type(symbol.data_type))
+			txt = formate_string("\t%s \t%s, %s\n",
+				symbol.data_type == df32 ? "movss" : "movsd", slot, sse_args[symbol.arg_reg]);
+		else
+			txt = formate_string("\tmov \t%s, %s\n",
+				slot, get_reg_list(symbol.data_type)[int_args[symbol.arg_reg]]);
+
+		prologue = strjoin(prologue, txt);
+	}
+
+	CG->text = formate_string("%s%s%s", prologue, body, epilogue);
+	CG->text_capacity = 0;
+
+	list_free(params);
+}
+
+// text of `print("...")`, `printf("...")` or `putchar(c)` with constant argument.
+const char *const_print(ast_T *root)
+{
+	if (root->type != ast_call || is_defined_function(root->token->value)) return NULL;
+
+	const char *name = root->token->value;
+	ast_T *arg = root->left;
+	if (!arg || arg->type != ast_const) return NULL;
+
+	if (!strcmp(name, "print") && arg->data_type == dstr)
+		return arg->token->value;
+
+	if (!strcmp(name, "printf") && arg->data_type == dstr && !strchr(arg->token->value, '%'))
+		return arg->token->value;
+
+	if (!strcmp(name, "putchar") && arg->data_type != dstr)
+	{
+		int64_t c = strtoll(arg->token->value, NULL, 10);
+		if (c > 0 && c < 256) return formate_string("%c", (char)c);
+	}
+
+	return NULL;
+}
+
+// prints of constants which follow each other are written by one call.
+void print_merged(list_T *statements, size_t *i)
+{
+	const char *text = "";
+	const char *piece;
+
+	while (*i < list_length(statements) && (piece = const_print(list_get(statements, *i))))
+	{
+		text = strjoin(text, piece);
+		(*i)++;
+	}
+
+	add_extern("tl_write");
+	append_text(formate_string(
+		"\tlea \trdi, [%s]\n\tmov \tesi, %ld\n\tcall \ttl_write\n",
+		use_literal(text, false), strlen(text)));
+}
+
+void statement(ast_T *root)
+{
+	if (!root) return;
+
+	switch (root->type)
+	{
+		case ast_join:
+		{
+			list_T *statements = init_list(sizeof(ast_T *));
+			flatten_join(root, statements);
+
+			for (size_t i = 0; i < list_length(statements);)
+			{
+				if (const_print(list_get(statements, i)))
+					print_merged(statements, &i);
+				else
+					statement(list_get(statements, i++));
+			}
+
+			list_free(statements);
+		} break;
+
+		case ast_call:
+			if (const_print(root))
+			{
+				list_T *statements = init_list(sizeof(ast_T *));
+				list_push(statements, root);
+
+				size_t i = 0;
+				print_merged(statements, &i);
+				list_free(statements);
+				break;
+			}
+
+			call(root);
+			free_reg();
+			break;
+
+		// inlined call whose value is not used, arms can still have calls.
+		case ast_select:
+			expr(root);
+			free_reg();
+			break;
+
+		case ast_assign:
+			assign(root);
+			break;
+
+		case ast_at_asm:
+			at_asm(root);
+			break;
+
+		// functions are generated after top level code, see init_asmgen.
+		case ast_function:
+			list_push(PENDING, root);
+			break;
+
+		case ast_return:
+			ret(root);
+			break;
+
+		case ast_if:
+			if_statement(root);
+			break;
+
+		case ast_while:
+			while_statement(root);
+			break;
+
+		case ast_store:
+			store(root);
+			break;
+
+		case ast_at_bench:
+			bench(root);
+			break;
+
+		case ast_region:
+			region(root);
+			break;
+
+		default:
+			break;
+	}
+}
+
+static void init_codegen(codegen_T *cg)
+{
+	*cg = (codegen_T){
+		.text = "",
+		.externs = init_list(sizeof(char *)),
+		.literals = init_list(sizeof(literal_use_T *))
+	};
+
+	codegen_T *outer = CG;
+	CG = cg;
+	free_reg();
+	CG = outer;
+}
+
+// symbol is hashed by what code takes from it. locals are numbered in order they are
+// first seen, so locals which are added to or removed from other functions do not matter.
+static uint64_t hash_symbol(size_t index, list_T *locals, uint64_t hash)
+{
+	symbol_T *symbol = &SYMBOLS[index];
+
+	if (symbol->symb_c == CLOCAL)
+	{
+		size_t number = 0;
+		while (number < list_length(locals) && (size_t)list_get(locals, number) != index) number++;
+		if (number == list_length(locals)) list_push(locals, (void*)index);
+
+		hash = hash_bytes(&number, sizeof(number), hash);
+	}
+
+	hash = hash_bytes(&symbol->symb_s, sizeof(symbol->symb_s), hash);
+	hash = hash_bytes(&symbol->symb_c, sizeof(symbol->symb_c), hash);
+	hash = hash_bytes(&symbol->data_type, sizeof(symbol->data_type), hash);
+	hash = hash_bytes(&symbol->u64, sizeof(symbol->u64), hash);
+	hash = hash_bytes(&symbol->is_const, sizeof(symbol->is_const), hash);
+	hash = hash_bytes(&symbol->is_param, sizeof(symbol->is_param), hash);
+	hash = hash_bytes(&symbol->arg_reg, sizeof(symbol->arg_reg), hash);
+	hash = hash_bytes(&symbol->arg_stack, sizeof(symbol->arg_stack), hash);
+
+	return symbol->name ? hash_bytes(symbol->name, strlen(symbol->name) + 1, hash) : hash;
+}
+
+static uint64_t hash_node(ast_T *root, list_T *locals, uint64_t hash)
+{
+	if (!root) return hash_bytes("", 1, hash);
+
+	hash = hash_bytes(&root->type, sizeof(root->type), hash);
+	hash = hash_bytes(&root->data_type, sizeof(root->data_type), hash);
+	if (root->token && root->token->value)
+		hash = hash_bytes(root->token->value, strlen(root->token->value) + 1, hash);
+
+	// only these nodes hold slot of symbol in index.
+	if (root->type == ast_ident || root->type == ast_assign ||
+			root->type == ast_function || root->type == ast_alloca)
+		hash = hash_symbol(root->index, locals, hash);
+	else
+		hash = hash_bytes(&root->index, sizeof(root->index), hash);
+
+	// call of function which is not defined goes to runtime.
+	if (root->type == ast_call)
+	{
+		bool defined = is_defined_function(root->token->value);
+		hash = hash_bytes(&defined, sizeof(defined), hash);
+	}
+
+	hash = hash_node(root->left, locals, hash);
+	hash = hash_node(root->mid, locals, hash);
+	return hash_node(root->right, locals, hash);
+}
+
+// fingerprint covers everything code of function depends on: its tree after all passes
+// (so also bodies which were inlined into it) and symbols which it refers to.
+// positions of tokens are not part of it, they do not change code.
+static uint64_t fingerprint_function(ast_T *root)
+{
+	list_T *locals = init_list(sizeof(size_t));
+	uint64_t hash = hash_node(root, locals, HASH_SEED);
+	list_free(locals);
+
+	return hash;
+}
+
+// takes functions until none is left, each one is generated in its own context.
+static void *codegen_worker(void *arg)
+{
+	(void)arg;
+	codegen_T *outer = CG;
+
+	size_t i;
+	while ((i = __atomic_fetch_add(&NEXT_FUNCTION, 1, __ATOMIC_RELAXED)) < list_length(PENDING))
+	{
+		if (CONTEXTS[i].reused) continue;
+
+		ast_T *root = list_get(PENDING, i);
+		uint64_t fingerprint = CONTEXTS[i].fingerprint;
+		init_codegen(&CONTEXTS[i]);
+		CONTEXTS[i].fingerprint = fingerprint;
+		CG = &CONTEXTS[i];
+
+		report_begin_function(root->token->value);
+		function(root);
+		report_end();
+	}
+
+	CG = outer;
+	return NULL;
+}
+
+// code of function whose fingerprint did not change is taken from previous compile,
+// fingerprints are taken before any function is generated, which assigns slots of locals.
+static void reuse_functions(list_T *previous)
+{
+	size_t reused = 0;
+	for (size_t i = 0; i < list_length(PENDING); ++i)
+	{
+		codegen_T *cg = &CONTEXTS[i];
+		cg->fingerprint = fingerprint_function(list_get(PENDING, i));
+
+		fncache_entry_T *entry = fncache_find(previous, cg->fingerprint);
+		if (!entry) continue;
+
+		*cg = (codegen_T){
+			.text = (char*)entry->text,
+			.externs = entry->externs,
+			.literals = entry->literals,
+			.fingerprint = cg->fingerprint,
+			.reused = true
+		};
+		for (size_t j = 0; j < list_length(entry->literals); ++j)
+		{
+			literal_use_T *literal = list_get(entry->literals, j);
+			if (!string_pool_add(literal->text, literal->needs_length)) cg->errors++;
+		}
+		reused++;
+	}
+
+	report_count("functions_reused", reused);
+}
+
+// every function without errors is stored, entries of functions which are gone are dropped.
+static void store_functions(const char *output)
+{
+	list_T *entries = init_list(sizeof(fncache_entry_T *));
+	for (size_t i = 0; i < list_length(PENDING); ++i)
+	{
+		codegen_T *cg = &CONTEXTS[i];
+		if (cg->errors) continue;
+
+		fncache_entry_T *entry = malloc(sizeof(fncache_entry_T));
+		*entry = (fncache_entry_T){
+			.fingerprint = cg->fingerprint,
+			.text = cg->text,
+			.externs = cg->externs,
+			.literals = cg->literals
+		};
+		list_push(entries, entry);
+	}
+
+	fncache_store(output, entries);
+}
+
+// functions do not depend on each other, only on top level code which defines globals.
+// calling thread generates functions too.
+static void generate_functions(const char *output, int jobs, bool incremental)
+{
+	size_t count = list_length(PENDING);
+	CONTEXTS = calloc(count + 1, sizeof(codegen_T));
+	NEXT_FUNCTION = 0;
+
+	if (incremental) reuse_functions(fncache_load(output));
+
+	if (jobs < 1) jobs = 1;
+	if ((size_t)jobs > count) jobs = count ? count : 1;
+
+	pthread_t *workers = malloc(jobs * sizeof(pthread_t));
+	for (int i = 1; i < jobs; ++i)
+		pthread_create(&workers[i], NULL, codegen_worker, NULL);
+	codegen_worker(NULL);
+	for (int i = 1; i < jobs; ++i)
+		pthread_join(workers[i], NULL);
+	free(workers);
+
+	// joined in order of definition, so output is same for any number of threads.
+	size_t length = 0;
+	for (size_t i = 0; i < count; ++i) length += strlen(CONTEXTS[i].text);
+
+	section_func = malloc(length + 1);
+	char *at = section_func;
+	for (size_t i = 0; i < count; ++i)
+	{
+		at = stpcpy(at, CONTEXTS[i].text);
+		ERRORS += CONTEXTS[i].errors;
+		for (size_t j = 0; j < list_length(CONTEXTS[i].externs); ++j)
+			add_extern(list_get(CONTEXTS[i].externs, j));
+	}
+	*at = '\0';
+
+	// functions of program with errors may have been parsed from broken code.
+	if (incremental && !ERRORS) store_functions(output);
+}
+
+void init_asmgen(const char *output, ast_T *root, int jobs, bool incremental)
+{
+	if (!output) return;
+
+	OUTPUT = fopen(output, "w");
+
+	codegen_T top;
+	init_codegen(&top);
+	CG = &top;
+	PENDING = init_list(sizeof(ast_T *));
+
+	init_string_pool();
+	add_extern("tl_flush");
+	add_extern("exit");
+	data_defined = calloc(SYMBOL_SIZE, sizeof(bool));
+	globals = init_list(sizeof(global_T *));
+	global_weight = calloc(SYMBOL_SIZE, sizeof(uint64_t));
+	weigh_globals(root, 0);
+
+	section_rodata = formate_string("section '.rodata' align %d\n", STRPOOL_ALIGN);
+	report_begin("codegen");
+	statement(root);
+	generate_functions(output, jobs, incremental);
+	report_end();
+
+	// program starts with globals, then main is called and
+	// its return value becomes exit code, buffered output is flushed before exit.
+	trie_value_T sv = trie_find(symbol_trie_map, "main");
+	if (sv.is_value && SYMBOLS[sv.value.i32].symb_s == SFUNC)
+	{
+		uint64_t argc = SYMBOLS[sv.value.i32].u64;
+		if (argc > 0) append_text("\tmov \tedi, [rsp]\n");
+		if (argc > 1) append_text("\tlea \trsi, [rsp + 8]\n");
+		append_text("\tcall \tmain\n\tmov \tebx, eax\n");
+	}
+	else append_text("\txor \tebx, ebx\n");
+	append_text("\tcall \ttl_flush\n\tmov \tedi, ebx\n\tcall \texit\n");
+
+	char *header = "section '.text' executable\n";
+	for (size_t i = 0; i < list_length(CG->externs); ++i)
+		header = strjoin(header, formate_string("extrn %s\n", (char*)list_get(CG->externs, i)));
+	header = strjoin(header, "public _start\n_start:\n");
+
+	report_begin("layout");
+	layout_globals();
+	section_rodata = strjoin(section_rodata, string_pool_emit());
+	report_end();
+
+	report_begin("write");
+	fprintf(OUTPUT,"format ELF64\n%s%s%s%s%s%s",
+		header, CG->text, section_func, section_data, section_rodata, section_bss);
+	report_count("asm_bytes", ftell(OUTPUT));
+	fclose(OUTPUT);
+	report_end();
+
+	ERRORS += CG->errors;
+	CG = NULL;
 }
@@ -3,7 +3,76 @@
 
 #include "glob.h"
 #include "parser.h"
+#include "strpool.h"
+#include "fncache.h"
+#include "report.h"
 
-void init_asmgen(const char *output, ast_T *root);
+// globals used at least this much (after loop weighting) are hot
+#define GLOBAL_HOT_WEIGHT 8
+
+// use inside loop counts as this many uses outside of it
+#define GLOBAL_LOOP_WEIGHT 8
+
+// loops deeper than this are not weighted more
+#define GLOBAL_MAX_DEPTH 4
+
+// hot and cold globals are split at cache line
+#define GLOBAL_CACHE_LINE 64
+
+typedef struct {
+	const char *name;
+	data_type_T data_type;
+	// initial value, NULL if global is zero
+	const char *value;
+	bool is_const;
+	uint64_t weight;
+} global_T;
+
+// state of code generation, top level code has one and so has every function.
+// functions are generated in parallel, each into own text, and joined in order they were defined.
+typedef struct {
+	char *text;
+	// length of text and size of its buffer, capacity is 0 when text is not buffer of context (like reused code)
+	size_t text_length;
+	size_t text_capacity;
+	// externs which code calls, in order they were first used
+	list_T *externs;
+	// literals which code uses, literal_use_T *
+	list_T *literals;
+	// number of errors reported, code with errors is not cached
+	uint64_t errors;
+
+	// function code was taken from entry of previous compile with same fingerprint
+	uint64_t fingerprint;
+	bool reused;
+
+	bool reg_free[10];
+	// register holds its value sign/zero extended to 64 bits
+	bool extended[10];
+	char **from;
+	int reg_id;
+
+	// function that is being generated
+	ast_T *function;
+	bool framed;
+	bool uses_rbx;
+	uint64_t frame_size;
+
+	// bytes which calls being generated have pushed on stack, call pads stack for them
+	uint64_t push_depth;
+
+	// number of regions which are open at current statement
+	uint64_t region_depth;
+	// number of benchmarks which are running at current statement
+	uint64_t bench_depth;
+
+	// counter for local labels of if/while, they are local to function label
+	uint64_t label;
+} codegen_T;
+
+// functions are generated by `jobs` threads, output does not depend on their number.
+// when `incremental`, functions which did not change since previous compile to
+// same output are not generated again, their code is kept next to output.
+void init_asmgen(const char *output, ast_T *root, int jobs, bool incremental);
 
 #endif // __asmgen_h__
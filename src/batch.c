@@ -0,0 +1,250 @@
+#include "batch.h"
+#include <time.h>
+#include <errno.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+// files of one worker, it takes them from bottom and others steal from top.
+// workers are processes, so lock is shared between them.
+typedef struct {
+	pthread_mutex_t lock;
+	size_t top;
+	size_t bottom;
+} deque_T;
+
+// memory shared by workers: their queues, output lock and results of files
+typedef struct {
+	pthread_mutex_t output_lock;
+	int jobs;
+	deque_T *deques;
+	batch_result_T *results;
+} batch_T;
+
+list_T *batch_read_list(const char *path)
+{
+	FILE *file = fopen(path, "r");
+	if (!file)
+	{
+		fprintf(stderr, "err :: failed to open batch list `%s`.\n", path);
+		return NULL;
+	}
+
+	list_T *files = init_list(sizeof(char *));
+	char *line = NULL;
+	size_t capacity = 0;
+	ssize_t length;
+	while ((length = getline(&line, &capacity, file)) >= 0)
+	{
+		while (length > 0 && isspace((unsigned char)line[length - 1])) line[--length] = '\0';
+		if (length) list_push(files, strdup(line));
+	}
+
+	free(line);
+	fclose(file);
+
+	return files;
+}
+
+static double milliseconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// next file of worker, from its own queue first.
+static bool batch_take(batch_T *batch, int self, size_t *item)
+{
+	deque_T *own = &batch->deques[self];
+
+	pthread_mutex_lock(&own->lock);
+	bool found = own->top < own->bottom;
+	if (found) *item = --own->bottom;
+	pthread_mutex_unlock(&own->lock);
+	if (found) return true;
+
+	for (int i = 1; i < batch->jobs; ++i)
+	{
+		deque_T *victim = &batch->deques[(self + i) % batch->jobs];
+
+		pthread_mutex_lock(&victim->lock);
+		found = victim->top < victim->bottom;
+		if (found) *item = victim->top++;
+		pthread_mutex_unlock(&victim->lock);
+		if (found) return true;
+	}
+
+	return false;
+}
+
+static char *batch_output_path(const char *file)
+{
+	size_t length = strlen(file);
+	if (length > 3 && !strcmp(file + length - 3, ".tl")) length -= 3;
+
+	return formate_string("%s%s", strsub(file, 0, length), BATCH_OUTPUT_EXTENSION);
+}
+
+// compiles file in forked child, its output is captured in `log`.
+static int batch_compile(const char *file, list_T *options, FILE *log, compile_T compile)
+{
+	pid_t pid = fork();
+	if (pid < 0)
+	{
+		fprintf(log, "err :: failed to fork compile: %s.\n", strerror(errno));
+		return -1;
+	}
+
+	if (pid == 0)
+	{
+		list_T *arguments = init_list(sizeof(char *));
+		list_push(arguments, "tlang");
+		for (size_t i = 0; i < list_length(options); ++i)
+			list_push(arguments, list_get(options, i));
+		// workers already use every core.
+		list_push(arguments, "--jobs=1");
+		list_push(arguments, formate_string("--output=%s", batch_output_path(file)));
+		list_push(arguments, (void*)file);
+
+		fflush(stdout);
+		dup2(fileno(log), STDOUT_FILENO);
+		dup2(fileno(log), STDERR_FILENO);
+
+		int code = compile(list_length(arguments), (char **)arguments->buffer);
+		fflush(stdout);
+		fflush(stderr);
+		_exit(code & 0xff);
+	}
+
+	int status;
+	while (waitpid(pid, &status, 0) < 0)
+		if (errno != EINTR) return -1;
+
+	return WIFEXITED(status) ? (int8_t)WEXITSTATUS(status) : 128 + WTERMSIG(status);
+}
+
+// output is shown when file failed or compiler reported errors or warnings.
+static void batch_show_output(batch_T *batch, const char *file, int code, FILE *log)
+{
+	size_t length = ftell(log);
+	char *text = calloc(length + 1, 1);
+	rewind(log);
+	if (fread(text, 1, length, log) != length) length = 0;
+	text[length] = '\0';
+
+	if (code || strstr(text, "err ::") || strstr(text, "warn ::"))
+	{
+		pthread_mutex_lock(&batch->output_lock);
+		printf("== %s ==\n", file);
+		fwrite(text, 1, length, stdout);
+		fflush(stdout);
+		pthread_mutex_unlock(&batch->output_lock);
+	}
+
+	free(text);
+}
+
+static void batch_worker(batch_T *batch, int self, list_T *files, list_T *options, compile_T compile)
+{
+	size_t item;
+	while (batch_take(batch, self, &item))
+	{
+		const char *file = list_get(files, item);
+		FILE *log = tmpfile();
+		if (!log)
+		{
+			batch->results[item] = (batch_result_T){ .code = -1, .done = true };
+			continue;
+		}
+
+		double start = milliseconds();
+		int code = batch_compile(file, options, log, compile);
+		batch->results[item] = (batch_result_T){ .code = code, .ms = milliseconds() - start, .done = true };
+
+		batch_show_output(batch, file, code, log);
+		fclose(log);
+	}
+}
+
+static void *shared_alloc(size_t size)
+{
+	void *memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+	return memory == MAP_FAILED ? NULL : memory;
+}
+
+int batch_run(list_T *files, list_T *options, int jobs, compile_T compile)
+{
+	size_t count = list_length(files);
+	if (jobs < 1) jobs = 1;
+	if ((size_t)jobs > count) jobs = count ? count : 1;
+
+	batch_T *batch = shared_alloc(sizeof(batch_T));
+	deque_T *deques = shared_alloc(jobs * sizeof(deque_T));
+	batch_result_T *results = shared_alloc((count + 1) * sizeof(batch_result_T));
+	if (!batch || !deques || !results)
+	{
+		perror("err :: failed to allocate memory for batch: ");
+		return count;
+	}
+
+	pthread_mutexattr_t attributes;
+	pthread_mutexattr_init(&attributes);
+	pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+
+	batch->jobs = jobs;
+	batch->deques = deques;
+	batch->results = results;
+	pthread_mutex_init(&batch->output_lock, &attributes);
+
+	// every worker starts with contiguous part of list.
+	for (int i = 0; i < jobs; ++i)
+	{
+		pthread_mutex_init(&deques[i].lock, &attributes);
+		deques[i].top = count * i / jobs;
+		deques[i].bottom = count * (i + 1) / jobs;
+	}
+
+	fflush(stdout);
+	fflush(stderr);
+	double start = milliseconds();
+
+	for (int i = 0; i < jobs; ++i)
+	{
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			batch_worker(batch, i, files, options, compile);
+			fflush(stdout);
+			_exit(0);
+		}
+		if (pid < 0)
+		{
+			perror("err :: failed to start batch worker: ");
+			break;
+		}
+	}
+	while (wait(NULL) > 0 || errno == EINTR);
+
+	int failed = 0;
+	printf("%-8s %12s  %s\n", "result", "time (ms)", "file");
+	for (size_t i = 0; i < count; ++i)
+	{
+		batch_result_T *result = &results[i];
+		if (!result->done || result->code) failed++;
+
+		char status[16];
+		if (!result->done) snprintf(status, sizeof(status), "skipped");
+		else if (result->code) snprintf(status, sizeof(status), "exit %d", result->code);
+		else snprintf(status, sizeof(status), "ok");
+
+		printf("%-8s %12.3f  %s\n", status, result->ms, (char*)list_get(files, i));
+	}
+	printf("%zu file(s), %d failed, %.3f ms with %d worker(s).\n",
+		count, failed, milliseconds() - start, jobs);
+
+	return failed;
+}
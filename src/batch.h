@@ -0,0 +1,27 @@
+#ifndef __batch_h__
+#define __batch_h__
+
+#include "glob.h"
+#include "list.h"
+#include "server.h"
+
+// output of file is its path with `.tl` replaced by this
+#define BATCH_OUTPUT_EXTENSION ".asm"
+
+// result of one file of batch
+typedef struct {
+	int code;
+	double ms;
+	bool done;
+} batch_result_T;
+
+// reads list of files, one path per line, empty lines are skipped. NULL if it cannot be read.
+list_T *batch_read_list(const char *path);
+
+// compiles files with `jobs` workers, every file with same options. workers start from state
+// which was prepared once and take files from their own queue, then steal from others.
+// output of file which failed or printed errors is shown with its name, then table of results.
+// returns number of files which failed.
+int batch_run(list_T *files, list_T *options, int jobs, compile_T compile);
+
+#endif // __batch_h__
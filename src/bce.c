@@ -0,0 +1,709 @@
+#include "bce.h"
+#include "comptime.h"
+
+static bce_stats_T STATS;
+
+// innermost loop which is being analyzed and its hoistable checks
+static ast_T *LOOP = NULL;
+static list_T *CANDIDATES = NULL;
+
+static bool bce_is_term(ast_T *ast)
+{
+	if (ast->type == ast_ident)
+		return ast->data_type != dstr && !is_float_data_type(ast->data_type);
+
+	return ast->type == ast_const && ast->token->type == tt_const_int;
+}
+
+// comparison of variable with constant or another variable as fact.
+static bool bce_as_fact(ast_T *cond, bool negate, fact_T *fact)
+{
+	if (!is_comparison(cond->type)) return false;
+
+	ast_T *left = cond->left, *right = cond->right;
+	if (!bce_is_term(left) || !bce_is_term(right)) return false;
+
+	ast_type_T op = negate ? comparison_inverse(cond->type) : cond->type;
+	if (left->type == ast_const)
+	{
+		ast_T *tmp = left;
+		left = right;
+		right = tmp;
+		op = comparison_mirror(op);
+	}
+
+	if (left->type == ast_const) return false;
+
+	bool is_signed = is_signed_data_type(left->data_type);
+
+	*fact = (fact_T){ .var = left->index, .op = op };
+	if (right->type == ast_const)
+	{
+		fact->is_const = true;
+		fact->value = strtoll(right->token->value, NULL, 10);
+
+		// out of range constants are not worth the trouble.
+		if (fact->value == INT64_MAX || fact->value == INT64_MIN) return false;
+		if (!is_signed && fact->value < 0) return false;
+	}
+	else
+	{
+		// comparisons of mixed signedness are not analyzed.
+		if (is_signed_data_type(right->data_type) != is_signed) return false;
+		if (right->index == left->index) return false;
+
+		fact->bound = right->index;
+	}
+
+	return true;
+}
+
+static bool bce_mentions(fact_T *fact, size_t slot)
+{
+	return fact->var == slot || (!fact->is_const && fact->bound == slot);
+}
+
+static list_T *bce_add(list_T *facts, fact_T fact)
+{
+	list_T *list = init_list(sizeof(fact_T *));
+	list_extend(list, facts);
+
+	fact_T *f = malloc(sizeof(fact_T));
+	*f = fact;
+	list_push(list, f);
+
+	return list;
+}
+
+static list_T *bce_add_cond(list_T *facts, ast_T *cond, bool negate)
+{
+	fact_T fact;
+	return bce_as_fact(cond, negate, &fact) ? bce_add(facts, fact) : facts;
+}
+
+static list_T *bce_kill(list_T *facts, size_t slot)
+{
+	list_T *list = init_list(sizeof(fact_T *));
+	for (size_t i = 0; i < list_length(facts); ++i)
+	{
+		fact_T *f = list_get(facts, i);
+		if (!bce_mentions(f, slot)) list_push(list, f);
+	}
+
+	return list;
+}
+
+// globals can be changed by any call.
+static list_T *bce_kill_globals(list_T *facts)
+{
+	list_T *list = init_list(sizeof(fact_T *));
+	for (size_t i = 0; i < list_length(facts); ++i)
+	{
+		fact_T *f = list_get(facts, i);
+		if (SYMBOLS[f->var].symb_c == CGLOBAL) continue;
+		if (!f->is_const && SYMBOLS[f->bound].symb_c == CGLOBAL) continue;
+		list_push(list, f);
+	}
+
+	return list;
+}
+
+static bool bce_same(fact_T *a, fact_T *b)
+{
+	return
+		a->var == b->var && a->op == b->op && a->is_const == b->is_const &&
+		(a->is_const ? a->value == b->value : a->bound == b->bound);
+}
+
+static list_T *bce_intersect(list_T *a, list_T *b)
+{
+	list_T *list = init_list(sizeof(fact_T *));
+	for (size_t i = 0; i < list_length(a); ++i)
+	{
+		fact_T *f = list_get(a, i);
+		for (size_t j = 0; j < list_length(b); ++j)
+		{
+			if (!bce_same(f, list_get(b, j))) continue;
+
+			list_push(list, f);
+			break;
+		}
+	}
+
+	return list;
+}
+
+static void bce_type_range(data_type_T data_type, int64_t *lo, int64_t *hi)
+{
+	uint8_t size = get_data_type_size(data_type);
+	if (size == 0 || size > 8) size = 8;
+
+	if (is_signed_data_type(data_type))
+	{
+		*lo = size == 8 ? INT64_MIN : -((int64_t)1 << (size * 8 - 1));
+		*hi = size == 8 ? INT64_MAX : ((int64_t)1 << (size * 8 - 1)) - 1;
+	}
+	else
+	{
+		// INT64_MAX of u64 means it is not bounded.
+		*lo = 0;
+		*hi = size == 8 ? INT64_MAX : ((int64_t)1 << (size * 8)) - 1;
+	}
+}
+
+// interval of variable, bounds of other variables are looked up `depth` times.
+static void bce_range(list_T *facts, size_t var, int64_t *lo, int64_t *hi, int depth)
+{
+	bce_type_range(SYMBOLS[var].data_type, lo, hi);
+
+	for (size_t i = 0; i < list_length(facts); ++i)
+	{
+		fact_T *f = list_get(facts, i);
+		ast_type_T op = f->op;
+		int64_t blo, bhi;
+
+		if (f->is_const)
+		{
+			if (f->var != var) continue;
+			blo = bhi = f->value;
+		}
+		else if (depth > 0 && (f->var == var || f->bound == var))
+		{
+			size_t other = f->var == var ? f->bound : f->var;
+			if (f->var != var) op = comparison_mirror(op);
+			bce_range(facts, other, &blo, &bhi, depth - 1);
+		}
+		else continue;
+
+		switch (op)
+		{
+			case ast_lt:
+				if (bhi < INT64_MAX && bhi - 1 < *hi) *hi = bhi - 1;
+				break;
+			case ast_lte:
+				if (bhi < *hi) *hi = bhi;
+				break;
+			case ast_gt:
+				if (blo < INT64_MAX && blo + 1 > *lo) *lo = blo + 1;
+				break;
+			case ast_gte:
+				if (blo > *lo) *lo = blo;
+				break;
+			case ast_eq:
+				if (bhi < *hi) *hi = bhi;
+				if (blo > *lo) *lo = blo;
+				break;
+			default: break;
+		}
+	}
+}
+
+// 1 if `[lo1, hi1] op [lo2, hi2]` always holds, 0 if it never holds, -1 if unknown.
+static int bce_decide(ast_type_T op, int64_t lo1, int64_t hi1, int64_t lo2, int64_t hi2)
+{
+	switch (op)
+	{
+		case ast_lt:
+			if (hi1 < INT64_MAX && hi1 < lo2) return 1;
+			if (hi2 < INT64_MAX && lo1 >= hi2) return 0;
+			return -1;
+		case ast_lte:
+			if (hi1 < INT64_MAX && hi1 <= lo2) return 1;
+			if (hi2 < INT64_MAX && lo1 > hi2) return 0;
+			return -1;
+		case ast_gt:
+		case ast_gte:
+			return bce_decide(comparison_mirror(op), lo2, hi2, lo1, hi1);
+		case ast_eq:
+			if (hi1 < INT64_MAX && lo1 == hi1 && lo2 == hi2 && lo1 == lo2) return 1;
+			if ((hi1 < INT64_MAX && hi1 < lo2) || (hi2 < INT64_MAX && hi2 < lo1)) return 0;
+			return -1;
+		case ast_neq:
+		{
+			int eq = bce_decide(ast_eq, lo1, hi1, lo2, hi2);
+			return eq < 0 ? -1 : !eq;
+		}
+		default:
+			return -1;
+	}
+}
+
+// check if relation `a rel b` implies `a op b`.
+static bool bce_implies(ast_type_T rel, ast_type_T op)
+{
+	switch (rel)
+	{
+		case ast_lt: 	return op == ast_lt || op == ast_lte || op == ast_neq;
+		case ast_gt: 	return op == ast_gt || op == ast_gte || op == ast_neq;
+		case ast_eq: 	return op == ast_lte || op == ast_gte || op == ast_eq;
+		default: 			return rel == op;
+	}
+}
+
+static int bce_check(ast_type_T rel, ast_type_T op)
+{
+	if (bce_implies(rel, op)) return 1;
+	if (bce_implies(rel, comparison_inverse(op))) return 0;
+	return -1;
+}
+
+// `a rel1 b` and `b rel2 c` gives `a rel c`.
+static ast_type_T bce_chain(ast_type_T rel1, ast_type_T rel2)
+{
+	if (rel1 == ast_eq) return rel2;
+	if (rel2 == ast_eq) return rel1;
+
+	bool up1 = rel1 == ast_lt || rel1 == ast_lte, up2 = rel2 == ast_lt || rel2 == ast_lte;
+	bool down1 = rel1 == ast_gt || rel1 == ast_gte, down2 = rel2 == ast_gt || rel2 == ast_gte;
+
+	if (up1 && up2) return (rel1 == ast_lt || rel2 == ast_lt) ? ast_lt : ast_lte;
+	if (down1 && down2) return (rel1 == ast_gt || rel2 == ast_gt) ? ast_gt : ast_gte;
+	return ast_noop;
+}
+
+// fact seen from variable `from`, returns false if it does not mention it.
+static bool bce_orient(fact_T *f, size_t from, ast_type_T *rel, size_t *to)
+{
+	if (f->is_const || f->op == ast_neq) return false;
+
+	if (f->var == from)
+	{
+		*rel = f->op;
+		*to = f->bound;
+		return true;
+	}
+	if (f->bound == from)
+	{
+		*rel = comparison_mirror(f->op);
+		*to = f->var;
+		return true;
+	}
+
+	return false;
+}
+
+// prove `a op b` from relations between variables (one step of transitivity).
+static int bce_prove_relation(list_T *facts, size_t a, size_t b, ast_type_T op)
+{
+	for (size_t i = 0; i < list_length(facts); ++i)
+	{
+		ast_type_T rel;
+		size_t mid;
+		if (!bce_orient(list_get(facts, i), a, &rel, &mid)) continue;
+
+		if (mid == b)
+		{
+			int r = bce_check(rel, op);
+			if (r >= 0) return r;
+			continue;
+		}
+
+		for (size_t j = 0; j < list_length(facts); ++j)
+		{
+			ast_type_T rel2;
+			size_t to;
+			if (i == j || !bce_orient(list_get(facts, j), mid, &rel2, &to) || to != b) continue;
+
+			ast_type_T chained = bce_chain(rel, rel2);
+			if (chained == ast_noop) continue;
+
+			int r = bce_check(chained, op);
+			if (r >= 0) return r;
+		}
+	}
+
+	return -1;
+}
+
+// 1 if condition always holds, 0 if it never holds, -1 if unknown.
+static int bce_prove(list_T *facts, ast_T *cond)
+{
+	if (cond->type == ast_const && cond->token->type == tt_const_int)
+		return strtoll(cond->token->value, NULL, 10) != 0;
+
+	fact_T c;
+	if (!bce_as_fact(cond, false, &c)) return -1;
+
+	int64_t lo1, hi1, lo2, hi2;
+	bce_range(facts, c.var, &lo1, &hi1, 1);
+
+	if (c.is_const)
+		return bce_decide(c.op, lo1, hi1, c.value, c.value);
+
+	int r = bce_prove_relation(facts, c.var, c.bound, c.op);
+	if (r >= 0) return r;
+
+	bce_range(facts, c.bound, &lo2, &hi2, 1);
+	return bce_decide(c.op, lo1, hi1, lo2, hi2);
+}
+
+static bool bce_ends_with_return(ast_T *root)
+{
+	if (!root) return false;
+
+	switch (root->type)
+	{
+		case ast_return: 	return true;
+		case ast_join: 		return bce_ends_with_return(root->right) || bce_ends_with_return(root->left);
+		case ast_if: 			return bce_ends_with_return(root->mid) && bce_ends_with_return(root->right);
+		default: 					return false;
+	}
+}
+
+static bool bce_assigns(ast_T *root, size_t slot)
+{
+	if (!root) return false;
+	if (root->type == ast_assign && root->index == slot) return true;
+
+	return
+		bce_assigns(root->left, slot) ||
+		bce_assigns(root->mid, slot) ||
+		bce_assigns(root->right, slot);
+}
+
+static bool bce_is_invariant(ast_T *loop, size_t slot)
+{
+	if (bce_assigns(loop, slot) || ast_contains(loop, ast_at_asm)) return false;
+	return SYMBOLS[slot].symb_c != CGLOBAL || !ast_contains(loop, ast_call);
+}
+
+// `var + c` or `c + var`, returns c.
+static bool bce_increment(ast_T *assign, int64_t *step)
+{
+	ast_T *value = assign->left;
+	if (!value || value->type != ast_add) return false;
+
+	ast_T *var = value->left, *c = value->right;
+	if (var->type == ast_const)
+	{
+		var = value->right;
+		c = value->left;
+	}
+
+	if (var->type != ast_ident || var->index != assign->index) return false;
+	if (c->type != ast_const || c->token->type != tt_const_int) return false;
+
+	*step = strtoll(c->token->value, NULL, 10);
+	return *step >= 0;
+}
+
+// number of increments of counter by one, -1 if it is changed in any other way.
+static int bce_count_increments(ast_T *root, size_t slot, bool nested)
+{
+	if (!root) return 0;
+
+	if (root->type == ast_assign && root->index == slot)
+	{
+		// increment in nested loop can happen more than once per iteration.
+		int64_t step;
+		if (nested || !bce_increment(root, &step) || step != 1) return -1;
+		return 1;
+	}
+
+	nested = nested || root->type == ast_while;
+	int l = bce_count_increments(root->left, slot, nested);
+	int m = bce_count_increments(root->mid, slot, nested);
+	int r = bce_count_increments(root->right, slot, nested);
+
+	if (l < 0 || m < 0 || r < 0) return -1;
+	return l + m + r;
+}
+
+// `i` of `while (i < n) { ...; i = i + 1; }`, which grows at most by one per
+// iteration and cannot overflow, so its lower bounds stay true in the loop.
+static bool bce_is_counter(ast_T *loop, size_t slot)
+{
+	fact_T c;
+	if (!bce_as_fact(loop->left, false, &c) || c.var != slot || c.op != ast_lt) return false;
+
+	return bce_count_increments(loop->mid, slot, false) == 1;
+}
+
+// keep only lower bounds of variable (upper bounds of variables bounded by it).
+static list_T *bce_keep_lower(list_T *facts, size_t slot)
+{
+	list_T *list = init_list(sizeof(fact_T *));
+	for (size_t i = 0; i < list_length(facts); ++i)
+	{
+		fact_T *f = list_get(facts, i);
+		if (!bce_mentions(f, slot))
+		{
+			list_push(list, f);
+			continue;
+		}
+
+		ast_type_T op = f->var == slot ? f->op : comparison_mirror(f->op);
+		if (op == ast_eq) op = ast_gte;
+		if (op != ast_gt && op != ast_gte) continue;
+
+		fact_T *kept = malloc(sizeof(fact_T));
+		*kept = *f;
+		kept->op = f->var == slot ? op : comparison_mirror(op);
+		list_push(list, kept);
+	}
+
+	return list;
+}
+
+static void bce_collect_assigned(ast_T *root, bool *assigned)
+{
+	if (!root) return;
+	if (root->type == ast_assign) assigned[root->index] = true;
+
+	bce_collect_assigned(root->left, assigned);
+	bce_collect_assigned(root->mid, assigned);
+	bce_collect_assigned(root->right, assigned);
+}
+
+// facts which are true at the start of each iteration.
+static list_T *bce_loop_facts(list_T *facts, ast_T *loop)
+{
+	if (ast_contains(loop, ast_at_asm)) return init_list(sizeof(fact_T *));
+	if (ast_contains(loop, ast_call)) facts = bce_kill_globals(facts);
+
+	bool *assigned = calloc(SYMBOL_SIZE, sizeof(bool));
+	bce_collect_assigned(loop->mid, assigned);
+
+	for (size_t slot = 0; slot < SYMBOL_SIZE; ++slot)
+	{
+		if (!assigned[slot]) continue;
+
+		facts = bce_is_counter(loop, slot) ?
+			bce_keep_lower(facts, slot) :
+			bce_kill(facts, slot);
+	}
+
+	free(assigned);
+	return facts;
+}
+
+static list_T *bce_assign(ast_T *root, list_T *facts)
+{
+	size_t slot = root->index;
+
+	if (root->left && ast_contains(root->left, ast_call)) facts = bce_kill_globals(facts);
+	if (!root->left) return bce_kill(facts, slot);
+
+	int64_t step, lo, hi, tlo, thi;
+	bce_range(facts, slot, &lo, &hi, 1);
+	bce_type_range(SYMBOLS[slot].data_type, &tlo, &thi);
+
+	// `i = i + c` which does not overflow moves the bounds of `i`.
+	if (bce_increment(root, &step) && hi <= thi - step)
+	{
+		list_T *list = bce_keep_lower(facts, slot);
+		for (size_t i = 0; i < list_length(facts); ++i)
+		{
+			fact_T *f = list_get(facts, i);
+			if (f->var != slot) continue;
+
+			if (f->is_const && f->value <= INT64_MAX - step &&
+					(f->op == ast_lt || f->op == ast_lte || f->op == ast_eq))
+				list = bce_add(list, (fact_T){ .var = slot, .op = f->op, .is_const = true, .value = f->value + step });
+			else if (!f->is_const && f->op == ast_lt && step == 1)
+				list = bce_add(list, (fact_T){ .var = slot, .op = ast_lte, .bound = f->bound });
+		}
+
+		return list;
+	}
+
+	facts = bce_kill(facts, slot);
+
+	// value which does not fit (or is truncated) says nothing.
+	ast_T *value = root->left;
+	if (value->type == ast_const && comptime_truncate(strtoll(value->token->value, NULL, 10), root->data_type) !=
+			strtoll(value->token->value, NULL, 10)) return facts;
+	if (value->type == ast_ident && get_data_type_size(value->data_type) > get_data_type_size(root->data_type))
+		return facts;
+
+	fact_T fact;
+	ast_T *ident = init_ast_leaf(ast_ident, root->data_type, root->token, slot);
+	if (bce_as_fact(init_ast(ast_eq, di32, root->token, ident, NULL, value, 0), false, &fact))
+		facts = bce_add(facts, fact);
+
+	return facts;
+}
+
+static void bce_candidate(list_T *facts, ast_T *check)
+{
+	if (!LOOP) return;
+
+	fact_T c;
+	if (!bce_as_fact(check->left, false, &c) || (c.op != ast_lt && c.op != ast_lte)) return;
+	if (!c.is_const && !bce_is_invariant(LOOP, c.bound)) return;
+
+	for (size_t i = 0; i < list_length(facts); ++i)
+	{
+		fact_T *f = list_get(facts, i);
+		if (f->is_const || f->var != c.var || (f->op != ast_lt && f->op != ast_lte)) continue;
+		if (!bce_is_invariant(LOOP, f->bound)) continue;
+
+		bce_candidate_T *candidate = malloc(sizeof(bce_candidate_T));
+		candidate->check = check;
+		candidate->n = f->bound;
+		candidate->strict = f->op == ast_lte && c.op == ast_lt;
+
+		position_T position = check->token->position;
+		candidate->m = c.is_const ?
+			init_ast_leaf(ast_const, dnil, init_token(tt_const_int, position, formate_string("%ld", c.value)), 0) :
+			init_ast_leaf(ast_ident, SYMBOLS[c.bound].data_type, init_token(tt_ident, position, SYMBOLS[c.bound].name), c.bound);
+
+		list_push(CANDIDATES, candidate);
+		return;
+	}
+}
+
+static bool bce_same_guard(bce_candidate_T *a, bce_candidate_T *b)
+{
+	return
+		a->n == b->n && a->strict == b->strict && a->m->type == b->m->type &&
+		(a->m->type == ast_const ? !strcmp(a->m->token->value, b->m->token->value) : a->m->index == b->m->index);
+}
+
+// clone of loop where hoisted checks are replaced by their body.
+static ast_T *bce_clone(ast_T *root, list_T *hoisted)
+{
+	if (!root) return NULL;
+
+	for (size_t i = 0; i < list_length(hoisted); ++i)
+		if (list_get(hoisted, i) == root)
+			return bce_clone(root->mid, hoisted);
+
+	ast_T *ast = init_ast(root->type, root->data_type, root->token, NULL, NULL, NULL, root->index);
+	ast->left = bce_clone(root->left, hoisted);
+	ast->mid = bce_clone(root->mid, hoisted);
+	ast->right = bce_clone(root->right, hoisted);
+
+	return ast;
+}
+
+// `if (n <= m) { loop without checks } else { loop }`
+static ast_T *bce_version(ast_T *loop)
+{
+	if (!list_length(CANDIDATES) || ast_cost(loop) > BCE_VERSION_LIMIT) return loop;
+
+	bce_candidate_T *first = list_get(CANDIDATES, 0);
+	list_T *hoisted = init_list(sizeof(ast_T *));
+	for (size_t i = 0; i < list_length(CANDIDATES); ++i)
+	{
+		bce_candidate_T *candidate = list_get(CANDIDATES, i);
+		if (bce_same_guard(first, candidate)) list_push(hoisted, candidate->check);
+	}
+
+	position_T position = loop->token->position;
+	ast_T *n = init_ast_leaf(ast_ident, SYMBOLS[first->n].data_type,
+		init_token(tt_ident, position, SYMBOLS[first->n].name), first->n);
+	ast_T *guard = init_ast(
+		first->strict ? ast_lt : ast_lte, di32,
+		init_token(first->strict ? tt_lt : tt_lte, position, first->strict ? "<" : "<="),
+		n, NULL, first->m, 0
+	);
+
+	ast_T *ast = init_ast(ast_if, dnil, loop->token, guard, NULL, loop, 0);
+	ast->mid = bce_clone(loop, hoisted);
+
+	STATS.hoisted += list_length(hoisted);
+	list_free(hoisted);
+
+	return ast;
+}
+
+static list_T *bce_analyze(ast_T **node, list_T *facts)
+{
+	ast_T *root = *node;
+	if (!root) return facts;
+
+	switch (root->type)
+	{
+		case ast_join:
+			facts = bce_analyze(&root->left, facts);
+			return bce_analyze(&root->right, facts);
+
+		case ast_assign:
+			return bce_assign(root, facts);
+
+		case ast_call:
+			return bce_kill_globals(facts);
+
+		case ast_at_asm:
+			return init_list(sizeof(fact_T *));
+
+		// body of benchmark runs many times, facts from before it do not hold inside.
+		case ast_at_bench:
+			bce_analyze(&root->left, init_list(sizeof(fact_T *)));
+			return init_list(sizeof(fact_T *));
+
+		case ast_region:
+			return bce_analyze(&root->left, bce_kill_globals(facts));
+
+		case ast_return:
+			return facts;
+
+		case ast_if:
+		{
+			int proven = bce_prove(facts, root->left);
+			if (proven >= 0)
+			{
+				STATS.eliminated++;
+				*node = proven ? root->mid : root->right;
+				return bce_analyze(node, facts);
+			}
+
+			if (ast_contains(root->left, ast_call)) facts = bce_kill_globals(facts);
+			bce_candidate(facts, root);
+
+			list_T *then_facts = bce_analyze(&root->mid, bce_add_cond(facts, root->left, false));
+			list_T *else_facts = bce_analyze(&root->right, bce_add_cond(facts, root->left, true));
+
+			// branch which returns does not continue after if.
+			if (bce_ends_with_return(root->mid)) return else_facts;
+			if (bce_ends_with_return(root->right)) return then_facts;
+			return bce_intersect(then_facts, else_facts);
+		}
+
+		case ast_while:
+		{
+			list_T *loop_facts = bce_loop_facts(facts, root);
+
+			ast_T *outer = LOOP;
+			list_T *outer_candidates = CANDIDATES;
+			LOOP = root;
+			CANDIDATES = init_list(sizeof(bce_candidate_T *));
+
+			bce_analyze(&root->mid, bce_add_cond(loop_facts, root->left, false));
+			*node = bce_version(root);
+
+			LOOP = outer;
+			CANDIDATES = outer_candidates;
+
+			return bce_add_cond(loop_facts, root->left, true);
+		}
+
+		default:
+			return facts;
+	}
+}
+
+ast_T *bce_eliminate(ast_T *root, bool report)
+{
+	list_T *functions = init_list(sizeof(ast_T *));
+	flatten_join(root, functions);
+
+	for (size_t i = 0; i < list_length(functions); ++i)
+	{
+		ast_T *function = list_get(functions, i);
+		if (!function || function->type != ast_function) continue;
+
+		report_begin_function(function->token->value);
+		STATS = (bce_stats_T){ 0 };
+		bce_analyze(&function->left, init_list(sizeof(fact_T *)));
+		report_end();
+
+		if (report)
+			printf("bce :: %s: %ld eliminated, %ld hoisted\n",
+				function->token->value, STATS.eliminated, STATS.hoisted);
+	}
+
+	list_free(functions);
+	return root;
+}
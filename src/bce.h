@@ -0,0 +1,38 @@
+#ifndef __bce_h__
+#define __bce_h__
+
+#include "glob.h"
+#include "parser.h"
+#include "report.h"
+
+// max cost (number of nodes) of loop that is versioned to hoist checks out of it
+#define BCE_VERSION_LIMIT 128
+
+// `var op value` or `var op bound`, where op is one of comparisons
+typedef struct {
+	size_t var;
+	ast_type_T op;
+	bool is_const;
+	int64_t value;
+	size_t bound;
+} fact_T;
+
+// check inside loop which holds for whole loop if `n < m` (or `n <= m`)
+typedef struct {
+	ast_T *check;
+	size_t n;
+	ast_T *m;
+	bool strict;
+} bce_candidate_T;
+
+// checks of a function that were removed
+typedef struct {
+	uint64_t eliminated;
+	uint64_t hoisted;
+} bce_stats_T;
+
+// remove checks (if statements) which are proven by range analysis,
+// and hoist the remaining ones out of counted loops
+ast_T *bce_eliminate(ast_T *root, bool report);
+
+#endif // __bce_h__
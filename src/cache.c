@@ -0,0 +1,272 @@
+#include "cache.h"
+#include "list.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+static const char *DIRECTORY = NULL;
+static uint64_t MAX_SIZE = CACHE_MAX_SIZE;
+
+// entry of cache directory, for eviction
+typedef struct {
+	char *path;
+	uint64_t size;
+	struct timespec used;
+} entry_T;
+
+static bool make_directories(const char *path)
+{
+	char *copy = strdup(path);
+	for (char *at = copy + 1; *at; ++at)
+	{
+		if (*at != '/') continue;
+
+		*at = '\0';
+		mkdir(copy, 0755);
+		*at = '/';
+	}
+	mkdir(copy, 0755);
+	free(copy);
+
+	struct stat st;
+	return !stat(path, &st) && S_ISDIR(st.st_mode);
+}
+
+bool cache_init(const char *directory, uint64_t max_size)
+{
+	if (!directory)
+	{
+		const char *xdg = getenv("XDG_CACHE_HOME");
+		const char *home = getenv("HOME");
+
+		if (xdg && *xdg) directory = formate_string("%s/%s", xdg, CACHE_DIR_NAME);
+		else if (home && *home) directory = formate_string("%s/.cache/%s", home, CACHE_DIR_NAME);
+		else return false;
+	}
+
+	if (!make_directories(directory))
+	{
+		printf("warn :: cache directory `%s` cannot be created, cache is not used.\n", directory);
+		return false;
+	}
+
+	DIRECTORY = directory;
+	MAX_SIZE = max_size;
+
+	return true;
+}
+
+// compiler is identified by its file, which is cheaper than reading it.
+uint64_t cache_compiler_hash()
+{
+	struct stat st;
+	if (stat("/proc/self/exe", &st)) return HASH_SEED;
+
+	uint64_t hash = hash_bytes(&st.st_ino, sizeof(st.st_ino), HASH_SEED);
+	hash = hash_bytes(&st.st_size, sizeof(st.st_size), hash);
+
+	return hash_bytes(&st.st_mtim, sizeof(st.st_mtim), hash);
+}
+
+uint64_t cache_key(uint64_t modules_hash, const void *options, size_t options_size)
+{
+	uint64_t compiler = cache_compiler_hash();
+	uint64_t key = hash_bytes(&modules_hash, sizeof(modules_hash), HASH_SEED);
+	key = hash_bytes(&compiler, sizeof(compiler), key);
+
+	return hash_bytes(options, options_size, key);
+}
+
+static char *entry_path(uint64_t key)
+{
+	return formate_string("%s/%016lx%s", DIRECTORY, key, CACHE_EXTENSION);
+}
+
+static bool copy_file(const char *from, const char *to)
+{
+	FILE *in = fopen(from, "rb");
+	if (!in) return false;
+
+	FILE *out = fopen(to, "wb");
+	if (!out)
+	{
+		fclose(in);
+		return false;
+	}
+
+	char buffer[1 << 16];
+	size_t length;
+	bool success = true;
+	while (success && (length = fread(buffer, 1, sizeof(buffer), in)) > 0)
+		success = fwrite(buffer, 1, length, out) == length;
+
+	success &= !ferror(in);
+	fclose(in);
+	success &= !fclose(out);
+
+	return success;
+}
+
+// hits and misses are shared by all compiles, file is locked while it is updated.
+static void count_lookup(bool hit)
+{
+	char *path = formate_string("%s/%s", DIRECTORY, CACHE_STATS);
+	int fd = open(path, O_RDWR | O_CREAT, 0644);
+	free(path);
+	if (fd < 0) return;
+
+	flock(fd, LOCK_EX);
+	char text[64] = "";
+	ssize_t length = read(fd, text, sizeof(text) - 1);
+	text[length > 0 ? length : 0] = '\0';
+
+	uint64_t hits = 0, misses = 0;
+	sscanf(text, "%lu %lu", &hits, &misses);
+	if (hit) hits++;
+	else misses++;
+
+	length = snprintf(text, sizeof(text), "%lu %lu\n", hits, misses);
+	if (ftruncate(fd, 0) || pwrite(fd, text, length, 0) != length)
+		printf("warn :: failed to update cache stats.\n");
+	flock(fd, LOCK_UN);
+	close(fd);
+}
+
+bool cache_fetch(uint64_t key, const char *output)
+{
+	if (!DIRECTORY) return false;
+
+	char *path = entry_path(key);
+	bool hit = copy_file(path, output);
+
+	// time of last use orders entries for eviction.
+	if (hit) utimensat(AT_FDCWD, path, NULL, 0);
+	free(path);
+
+	count_lookup(hit);
+	return hit;
+}
+
+// entries of cache, `total` is their size.
+static list_T *cache_entries(uint64_t *total)
+{
+	list_T *entries = init_list(sizeof(entry_T *));
+	*total = 0;
+
+	DIR *dir = opendir(DIRECTORY);
+	if (!dir) return entries;
+
+	struct dirent *item;
+	while ((item = readdir(dir)))
+	{
+		size_t length = strlen(item->d_name);
+		if (length < strlen(CACHE_EXTENSION) ||
+				strcmp(item->d_name + length - strlen(CACHE_EXTENSION), CACHE_EXTENSION))
+			continue;
+
+		char *path = formate_string("%s/%s", DIRECTORY, item->d_name);
+		struct stat st;
+		if (stat(path, &st))
+		{
+			free(path);
+			continue;
+		}
+
+		entry_T *entry = malloc(sizeof(entry_T));
+		*entry = (entry_T){ .path = path, .size = st.st_size, .used = st.st_mtim };
+		list_push(entries, entry);
+		*total += st.st_size;
+	}
+	closedir(dir);
+
+	return entries;
+}
+
+static void entries_free(list_T *entries)
+{
+	for (size_t i = 0; i < list_length(entries); ++i)
+	{
+		entry_T *entry = list_get(entries, i);
+		free(entry->path);
+		free(entry);
+	}
+	list_free(entries);
+}
+
+static int compare_used(const void *a, const void *b)
+{
+	const entry_T *x = *(entry_T *const *)a, *y = *(entry_T *const *)b;
+
+	if (x->used.tv_sec != y->used.tv_sec) return (x->used.tv_sec > y->used.tv_sec) - (x->used.tv_sec < y->used.tv_sec);
+	return (x->used.tv_nsec > y->used.tv_nsec) - (x->used.tv_nsec < y->used.tv_nsec);
+}
+
+// least recently used entries are removed until cache fits its size.
+// another compile may remove same entry meanwhile, which is harmless.
+static void cache_evict()
+{
+	uint64_t total;
+	list_T *entries = cache_entries(&total);
+
+	if (total > MAX_SIZE)
+	{
+		qsort(entries->buffer, list_length(entries), sizeof(void *), compare_used);
+		for (size_t i = 0; i < list_length(entries) && total > MAX_SIZE; ++i)
+		{
+			entry_T *entry = list_get(entries, i);
+			if (!unlink(entry->path)) total -= entry->size;
+		}
+	}
+
+	entries_free(entries);
+}
+
+void cache_store(uint64_t key, const char *output)
+{
+	if (!DIRECTORY) return;
+
+	char *path = entry_path(key);
+	char *temporary = formate_string("%s.%d.tmp", path, getpid());
+
+	if (!copy_file(output, temporary) || rename(temporary, path))
+		unlink(temporary);
+
+	free(temporary);
+	free(path);
+
+	cache_evict();
+}
+
+void cache_print_stats(FILE *out)
+{
+	if (!DIRECTORY)
+	{
+		fprintf(out, "cache is not used.\n");
+		return;
+	}
+
+	uint64_t hits = 0, misses = 0, total;
+	char *path = formate_string("%s/%s", DIRECTORY, CACHE_STATS);
+	FILE *stats = fopen(path, "r");
+	free(path);
+	if (stats)
+	{
+		if (fscanf(stats, "%lu %lu", &hits, &misses) != 2) hits = misses = 0;
+		fclose(stats);
+	}
+
+	list_T *entries = cache_entries(&total);
+
+	fprintf(out, "%-24s %s\n", "directory", DIRECTORY);
+	fprintf(out, "%-24s %12ld\n", "entries", list_length(entries));
+	fprintf(out, "%-24s %12ld\n", "bytes", total);
+	fprintf(out, "%-24s %12ld\n", "max bytes", MAX_SIZE);
+	fprintf(out, "%-24s %12ld\n", "hits", hits);
+	fprintf(out, "%-24s %12ld\n", "misses", misses);
+	if (hits + misses)
+		fprintf(out, "%-24s %11.1f%%\n", "hit rate", 100.0 * hits / (hits + misses));
+
+	entries_free(entries);
+}
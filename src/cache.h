@@ -0,0 +1,34 @@
+#ifndef __cache_h__
+#define __cache_h__
+
+#include "glob.h"
+
+// directory under $XDG_CACHE_HOME (or ~/.cache) when `--cache-dir` is not given
+#define CACHE_DIR_NAME "tlang"
+
+// entries which were used least recently are removed above this size, `--cache-size` in MiB
+#define CACHE_MAX_SIZE (256ULL << 20)
+
+// entries are `<key>.asm`, hits and misses of all compiles are kept in `stats`
+#define CACHE_EXTENSION ".asm"
+#define CACHE_STATS "stats"
+
+// false if cache directory cannot be created, cache is then not used.
+bool cache_init(const char *directory, uint64_t max_size);
+
+// compiler which was rebuilt can emit different code for same input, so its binary is part of keys.
+uint64_t cache_compiler_hash();
+
+// key of output, from hash of modules (see load_modules), compiler binary and options which change output.
+uint64_t cache_key(uint64_t modules_hash, const void *options, size_t options_size);
+
+// copies entry of key to output, false if there is none.
+bool cache_fetch(uint64_t key, const char *output);
+
+// output is copied into cache under temporary name and renamed, so concurrent
+// compiles see either whole entry or none. old entries are evicted after it.
+void cache_store(uint64_t key, const char *output);
+
+void cache_print_stats(FILE *out);
+
+#endif // __cache_h__
@@ -0,0 +1,491 @@
+#include "comptime.h"
+
+comptime_T *init_comptime(uint64_t budget)
+{
+	comptime_T *ct = malloc(sizeof(comptime_T));
+	if (!ct)
+	{
+		printf("err :: init_comptime :: failed to allocate memory.\n");
+		return NULL;
+	}
+	ct->steps = 0;
+	ct->budget = budget;
+	ct->depth = 0;
+	ct->exhausted = false;
+	ct->quiet = false;
+	ct->frame = NULL;
+	return ct;
+}
+
+int64_t comptime_truncate(int64_t value, data_type_T data_type)
+{
+	switch (data_type)
+	{
+		case dchar:
+		case di8: 	return (int8_t)value;
+		case di16: 	return (int16_t)value;
+		case di32: 	return (int32_t)value;
+		case du8: 	return (uint8_t)value;
+		case du16: 	return (uint16_t)value;
+		case du32: 	return (uint32_t)value;
+		default: 		return value;
+	}
+}
+
+static comptime_value_T comptime_fail()
+{
+	return (comptime_value_T){ .value = 0, .ok = false };
+}
+
+static comptime_value_T comptime_error(comptime_T *ct, const char *message)
+{
+	if (!ct->quiet) compile_error("err :: %s\n", message);
+	return comptime_fail();
+}
+
+static int64_t *comptime_local(comptime_T *ct, size_t slot)
+{
+	if (!ct->frame) return NULL;
+
+	for (size_t i = 0; i < ct->frame->length; ++i)
+		if (ct->frame->slots[i] == slot)
+			return &ct->frame->values[i];
+
+	return NULL;
+}
+
+static void comptime_set_local(comptime_T *ct, size_t slot, int64_t value)
+{
+	int64_t *local = comptime_local(ct, slot);
+	if (local)
+	{
+		*local = value;
+		return;
+	}
+
+	comptime_frame_T *frame = ct->frame;
+	frame->slots = realloc(frame->slots, sizeof(size_t) * (frame->length + 1));
+	frame->values = realloc(frame->values, sizeof(int64_t) * (frame->length + 1));
+	frame->slots[frame->length] = slot;
+	frame->values[frame->length++] = value;
+}
+
+static void comptime_exec(comptime_T *ct, ast_T *root);
+
+static comptime_value_T comptime_call(comptime_T *ct, ast_T *root)
+{
+	trie_value_T sv = trie_find(symbol_trie_map, root->token->value);
+	ast_T *function = sv.is_value ? FUNCTIONS[sv.value.i32] : NULL;
+	if (!function)
+		return comptime_error(ct, formate_string("`%s` is not known at compile time.", root->token->value));
+
+	if (ct->depth >= COMPTIME_MAX_DEPTH)
+		return comptime_error(ct, formate_string("@comptime exceeded max call depth of %d.", COMPTIME_MAX_DEPTH));
+
+	list_T *args = init_list(sizeof(ast_T *));
+	list_T *params = init_list(sizeof(ast_T *));
+	flatten_join(root->left, args);
+	flatten_join(function->mid, params);
+
+	comptime_frame_T frame = { 0 };
+	for (size_t i = 0; i < list_length(params) && i < list_length(args); ++i)
+	{
+		ast_T *param = list_get(params, i);
+		comptime_value_T v = comptime_eval(ct, list_get(args, i));
+		if (!v.ok)
+		{
+			list_free(args);
+			list_free(params);
+			return v;
+		}
+
+		frame.slots = realloc(frame.slots, sizeof(size_t) * (frame.length + 1));
+		frame.values = realloc(frame.values, sizeof(int64_t) * (frame.length + 1));
+		frame.slots[frame.length] = param->index;
+		frame.values[frame.length++] = comptime_truncate(v.value, param->data_type);
+	}
+
+	list_free(args);
+	list_free(params);
+
+	comptime_frame_T *caller = ct->frame;
+	ct->frame = &frame;
+	ct->depth++;
+
+	comptime_exec(ct, function->left);
+
+	ct->depth--;
+	ct->frame = caller;
+
+	free(frame.slots);
+	free(frame.values);
+
+	if (ct->exhausted) return comptime_fail();
+	if (!frame.returned)
+		return comptime_error(ct, formate_string("`%s` did not return value at compile time.", root->token->value));
+
+	return (comptime_value_T){ .value = comptime_truncate(frame.value, function->data_type), .ok = true };
+}
+
+static void comptime_exec(comptime_T *ct, ast_T *root)
+{
+	if (!root || ct->exhausted || ct->frame->returned) return;
+
+	switch (root->type)
+	{
+		case ast_join:
+			comptime_exec(ct, root->left);
+			comptime_exec(ct, root->right);
+			break;
+
+		case ast_assign:
+		{
+			if (!root->left) break;
+
+			if (SYMBOLS[root->index].symb_c != CLOCAL)
+			{
+				comptime_error(ct, formate_string("cannot assign global `%s` at compile time.", root->token->value));
+				ct->exhausted = true;
+				break;
+			}
+
+			comptime_value_T v = comptime_eval(ct, root->left);
+			if (!v.ok)
+			{
+				ct->exhausted = true;
+				break;
+			}
+
+			comptime_set_local(ct, root->index, comptime_truncate(v.value, root->data_type));
+		} break;
+
+		case ast_if:
+		{
+			comptime_value_T v = comptime_eval(ct, root->left);
+			if (!v.ok)
+			{
+				ct->exhausted = true;
+				break;
+			}
+
+			comptime_exec(ct, v.value ? root->mid : root->right);
+		} break;
+
+		case ast_while:
+		{
+			while (!ct->exhausted && !ct->frame->returned)
+			{
+				comptime_value_T v = comptime_eval(ct, root->left);
+				if (!v.ok)
+				{
+					ct->exhausted = true;
+					break;
+				}
+
+				if (!v.value) break;
+				comptime_exec(ct, root->mid);
+			}
+		} break;
+
+		case ast_return:
+		{
+			comptime_value_T v = comptime_eval(ct, root->left);
+			if (!v.ok)
+			{
+				ct->exhausted = true;
+				break;
+			}
+
+			ct->frame->returned = true;
+			ct->frame->value = v.value;
+		} break;
+
+		default:
+		{
+			if (!comptime_eval(ct, root).ok)
+				ct->exhausted = true;
+		}
+	}
+}
+
+comptime_value_T comptime_eval(comptime_T *ct, ast_T *root)
+{
+	if (!root || ct->exhausted) return comptime_fail();
+
+	if (++ct->steps > ct->budget)
+	{
+		comptime_error(ct, formate_string("@comptime exceeded step budget of %ld.", ct->budget));
+		ct->exhausted = true;
+		return comptime_fail();
+	}
+
+	switch (root->type)
+	{
+		case ast_const:
+		{
+			if (root->token->type != tt_const_int)
+				return comptime_error(ct, formate_string("`%s` is not an integer constant.", root->token->value));
+
+			return (comptime_value_T){ .value = strtoll(root->token->value, NULL, 10), .ok = true };
+		}
+
+		case ast_ident:
+		{
+			int64_t *local = comptime_local(ct, root->index);
+			if (local)
+				return (comptime_value_T){ .value = *local, .ok = true };
+
+			symbol_T symbol = SYMBOLS[root->index];
+			if (!symbol.is_const)
+				return comptime_error(ct, formate_string("`%s` is not known at compile time.", root->token->value));
+
+			return (comptime_value_T){ .value = (int64_t)symbol.u64, .ok = true };
+		}
+
+		case ast_call:
+			return comptime_call(ct, root);
+
+		case ast_select:
+		{
+			comptime_value_T v = comptime_eval(ct, root->left);
+			if (!v.ok) return v;
+
+			v = comptime_eval(ct, v.value ? root->mid : root->right);
+			if (!v.ok) return v;
+
+			return (comptime_value_T){ .value = comptime_truncate(v.value, root->data_type), .ok = true };
+		}
+
+		case ast_add:
+		case ast_sub:
+		case ast_mul:
+		case ast_div:
+		case ast_mod:
+		{
+			comptime_value_T l = comptime_eval(ct, root->left);
+			if (!l.ok) return l;
+
+			comptime_value_T r = comptime_eval(ct, root->right);
+			if (!r.ok) return r;
+
+			int64_t v = 0;
+			switch (root->type)
+			{
+				// wraps around like code of program does, signed overflow is undefined in c.
+				case ast_add: v = (int64_t)((uint64_t)l.value + (uint64_t)r.value); break;
+				case ast_sub: v = (int64_t)((uint64_t)l.value - (uint64_t)r.value); break;
+				case ast_mul: v = (int64_t)((uint64_t)l.value * (uint64_t)r.value); break;
+				case ast_div:
+				case ast_mod:
+				{
+					if (r.value == 0)
+						return comptime_error(ct, "division by zero in @comptime.");
+
+					bool is_div = root->type == ast_div;
+					if (root->data_type != dnil && !is_signed_data_type(root->data_type))
+						v = is_div ?
+							(int64_t)((uint64_t)l.value / (uint64_t)r.value) :
+							(int64_t)((uint64_t)l.value % (uint64_t)r.value);
+					// INT64_MIN / -1 wraps around.
+					else if (r.value == -1)
+						v = is_div ? (int64_t)(0 - (uint64_t)l.value) : 0;
+					else
+						v = is_div ? l.value / r.value : l.value % r.value;
+				} break;
+				default: break;
+			}
+
+			return (comptime_value_T){ .value = comptime_truncate(v, root->data_type), .ok = true };
+		}
+
+		case ast_lt:
+		case ast_lte:
+		case ast_gt:
+		case ast_gte:
+		case ast_eq:
+		case ast_neq:
+		{
+			comptime_value_T l = comptime_eval(ct, root->left);
+			if (!l.ok) return l;
+
+			comptime_value_T r = comptime_eval(ct, root->right);
+			if (!r.ok) return r;
+
+			// compared as the wider type of both operands.
+			data_type_T data_type = type_check(ast_add, root->left->data_type, root->right->data_type);
+			bool is_unsigned = data_type != dnil && !is_signed_data_type(data_type);
+			uint64_t ul = l.value, ur = r.value;
+
+			int64_t v = 0;
+			switch (root->type)
+			{
+				case ast_lt: v = is_unsigned ? ul < ur : l.value < r.value; break;
+				case ast_lte: v = is_unsigned ? ul <= ur : l.value <= r.value; break;
+				case ast_gt: v = is_unsigned ? ul > ur : l.value > r.value; break;
+				case ast_gte: v = is_unsigned ? ul >= ur : l.value >= r.value; break;
+				case ast_eq: v = l.value == r.value; break;
+				case ast_neq: v = l.value != r.value; break;
+				default: break;
+			}
+
+			return (comptime_value_T){ .value = v, .ok = true };
+		}
+
+		default:
+			return comptime_error(ct, formate_string("cannot evaluate `%s` at compile time.",
+					root->token ? root->token->value : "expression"));
+	}
+}
+
+ast_T *comptime_fold(ast_T *root, uint64_t budget)
+{
+	if (!root) return NULL;
+
+	comptime_T *ct = init_comptime(budget);
+	comptime_value_T v = comptime_eval(ct, root);
+	free(ct);
+
+	if (!v.ok) return NULL;
+
+	position_T position = root->token ? root->token->position : (position_T){ 0 };
+	token_T *token = init_token(tt_const_int, position, formate_string("%ld", v.value));
+
+	return init_ast_leaf(ast_const, root->data_type, token, 0);
+}
+
+static bool comptime_is_pure_tree(ast_T *root, bool *visiting);
+
+static bool comptime_is_pure_function(size_t slot, bool *visiting)
+{
+	if (!FUNCTIONS[slot]) return false;
+
+	// recursion is fine, step budget takes care of it.
+	if (visiting[slot]) return true;
+
+	visiting[slot] = true;
+	return comptime_is_pure_tree(FUNCTIONS[slot]->left, visiting);
+}
+
+static bool comptime_is_pure_tree(ast_T *root, bool *visiting)
+{
+	if (!root) return true;
+
+	switch (root->type)
+	{
+		case ast_at_asm:
+		case ast_at_bench:
+			return false;
+
+		case ast_assign:
+		case ast_ident:
+		{
+			// globals can change at runtime.
+			symbol_T symbol = SYMBOLS[root->index];
+			if (symbol.symb_c == CGLOBAL && !symbol.is_const) return false;
+		} break;
+
+		case ast_call:
+		{
+			trie_value_T sv = trie_find(symbol_trie_map, root->token->value);
+			if (!sv.is_value || !comptime_is_pure_function(sv.value.i32, visiting))
+				return false;
+		} break;
+
+		case ast_const:
+			if (root->data_type == dstr) return false;
+			break;
+
+		default: break;
+	}
+
+	return
+		comptime_is_pure_tree(root->left, visiting) &&
+		comptime_is_pure_tree(root->mid, visiting) &&
+		comptime_is_pure_tree(root->right, visiting);
+}
+
+bool comptime_is_pure(size_t slot)
+{
+	bool *visiting = calloc(SYMBOL_SIZE, sizeof(bool));
+	bool pure = comptime_is_pure_function(slot, visiting);
+	free(visiting);
+
+	return pure;
+}
+
+static bool comptime_const_args(ast_T *root)
+{
+	if (!root) return true;
+	if (root->type == ast_join)
+		return comptime_const_args(root->left) && comptime_const_args(root->right);
+
+	return root->type == ast_const && root->data_type != dstr;
+}
+
+ast_T *comptime_fold_constants(ast_T *root)
+{
+	if (!root) return NULL;
+
+	root->left = comptime_fold_constants(root->left);
+	root->mid = comptime_fold_constants(root->mid);
+	root->right = comptime_fold_constants(root->right);
+
+	bool foldable = false;
+	switch (root->type)
+	{
+		case ast_add:
+		case ast_sub:
+		case ast_mul:
+		case ast_div:
+		case ast_mod:
+		case ast_lt:
+		case ast_lte:
+		case ast_gt:
+		case ast_gte:
+		case ast_eq:
+		case ast_neq:
+			foldable =
+				root->left->type == ast_const && root->left->data_type != dstr &&
+				root->right->type == ast_const && root->right->data_type != dstr &&
+				!((root->type == ast_div || root->type == ast_mod) && !strcmp(root->right->token->value, "0"));
+			break;
+
+		// arm which is not taken is dropped, even if the other one is not constant.
+		case ast_select:
+			if (root->left->type == ast_const && root->left->data_type != dstr)
+			{
+				ast_T *arm = strtoll(root->left->token->value, NULL, 10) ? root->mid : root->right;
+				if (arm->type == ast_const && arm->data_type == dnil) arm->data_type = root->data_type;
+				return arm;
+			}
+			break;
+
+		case ast_call:
+		{
+			trie_value_T sv = trie_find(symbol_trie_map, root->token->value);
+			foldable =
+				sv.is_value && comptime_const_args(root->left) &&
+				comptime_is_pure(sv.value.i32);
+		} break;
+
+		default: break;
+	}
+
+	if (!foldable) return root;
+
+	// calls which are too expensive are left for runtime.
+	comptime_T *ct = init_comptime(COMPTIME_STEP_BUDGET);
+	ct->quiet = true;
+	comptime_value_T v = comptime_eval(ct, root);
+	free(ct);
+
+	if (!v.ok) return root;
+
+	token_T *token = init_token(
+		tt_const_int,
+		root->token ? root->token->position : (position_T){ 0 },
+		formate_string("%ld", v.value)
+	);
+
+	return init_ast_leaf(ast_const, root->data_type, token, 0);
+}
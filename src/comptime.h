@@ -0,0 +1,54 @@
+#ifndef __comptime_h__
+#define __comptime_h__
+
+#include "glob.h"
+#include "parser.h"
+
+// max number of nodes that can be visited while evaluating single @comptime
+#define COMPTIME_STEP_BUDGET 100000
+
+// max depth of function calls while evaluating
+#define COMPTIME_MAX_DEPTH 1024
+
+typedef struct {
+	int64_t value;
+	bool ok;
+} comptime_value_T;
+
+// locals of function that is being evaluated
+typedef struct {
+	size_t *slots;
+	int64_t *values;
+	size_t length;
+	bool returned;
+	int64_t value;
+} comptime_frame_T;
+
+typedef struct {
+	uint64_t steps;
+	uint64_t budget;
+	uint64_t depth;
+	bool exhausted;
+	bool quiet;
+	comptime_frame_T *frame;
+} comptime_T;
+
+// create evaluator with step budget
+comptime_T *init_comptime(uint64_t budget);
+
+// evaluate expression tree at compile time
+comptime_value_T comptime_eval(comptime_T *ct, ast_T *root);
+
+// truncate value to the width (and sign) of data type
+int64_t comptime_truncate(int64_t value, data_type_T data_type);
+
+// evaluate expression tree and replace it with constant
+ast_T *comptime_fold(ast_T *root, uint64_t budget);
+
+// check if function can be evaluated at compile time
+bool comptime_is_pure(size_t slot);
+
+// fold constant expressions and calls of pure functions with constant arguments
+ast_T *comptime_fold_constants(ast_T *root);
+
+#endif // __comptime_h__
@@ -0,0 +1,801 @@
+#define _GNU_SOURCE
+#include "document.h"
+#include "module.h"
+#include <unistd.h>
+
+// document whose declarations are in symbol table
+static document_T *ACTIVE = NULL;
+
+// compiler prints its errors, while document is lexed or parsed stdout is stream
+// which turns every line into diagnostic at position lexer or parser is at.
+static FILE *STREAM = NULL;
+static FILE *SAVED = NULL;
+static list_T *SINK = NULL;
+static lexer_T *LEXER = NULL;
+static parser_T *PARSER = NULL;
+// first token of statement which is parsed
+static ssize_t STATEMENT = 0;
+
+// item which declared global in slot, NULL for globals of imported modules
+static item_T **OWNER = NULL;
+// symbols whose declarations are hidden while items before them are parsed
+static list_T *HIDDEN = NULL;
+
+static char *LINE = NULL;
+static size_t LINE_LENGTH = 0, LINE_CAPACITY = 0;
+
+static void diagnostic_add(const char *line)
+{
+	position_T position = { .ln = 1, .clm = 1 };
+	uint64_t length = 1;
+
+	if (PARSER)
+	{
+		// error is printed after token it is about was eaten.
+		token_T *token = list_get(PARSER->tokens, PARSER->index > STATEMENT ? PARSER->index - 1 : PARSER->index);
+		position = token->position;
+		if (strlen(token->value)) length = strlen(token->value);
+	}
+	else if (LEXER) position = LEXER->position;
+
+	// `err ::` and `warn ::` are not part of message.
+	const char *message = strstr(line, "::");
+	message = message ? message + 2 : line;
+	while (*message == ' ') message++;
+
+	diagnostic_T *diagnostic = malloc(sizeof(diagnostic_T));
+	*diagnostic = (diagnostic_T){
+		.line = position.ln,
+		.column = position.clm,
+		.length = length,
+		.is_warning = !strncmp(line, "warn", 4),
+		.message = strdup(message)
+	};
+	list_push(SINK, diagnostic);
+}
+
+static ssize_t capture_write(void *cookie, const char *data, size_t size)
+{
+	(void)cookie;
+
+	for (size_t i = 0; i < size; ++i)
+	{
+		if (LINE_LENGTH + 1 >= LINE_CAPACITY)
+		{
+			LINE_CAPACITY = LINE_CAPACITY ? LINE_CAPACITY * 2 : 256;
+			LINE = realloc(LINE, LINE_CAPACITY);
+		}
+
+		if (data[i] != '\n')
+		{
+			LINE[LINE_LENGTH++] = data[i];
+			continue;
+		}
+
+		LINE[LINE_LENGTH] = '\0';
+		if (SINK && LINE_LENGTH) diagnostic_add(LINE);
+		LINE_LENGTH = 0;
+	}
+
+	return size;
+}
+
+// stream is line buffered, so every line is written while position it is about is current.
+static void capture_begin(list_T *sink)
+{
+	if (!STREAM)
+	{
+		STREAM = fopencookie(NULL, "w", (cookie_io_functions_t){ .write = capture_write });
+		setvbuf(STREAM, NULL, _IOLBF, 0);
+	}
+
+	fflush(stdout);
+	SAVED = stdout;
+	stdout = STREAM;
+	SINK = sink;
+}
+
+static void capture_end()
+{
+	fflush(stdout);
+	stdout = SAVED;
+	SINK = NULL;
+	LEXER = NULL;
+	PARSER = NULL;
+}
+
+static void diagnostics_clear(list_T *diagnostics)
+{
+	diagnostic_T *diagnostic;
+	while ((diagnostic = list_pop(diagnostics)))
+	{
+		free(diagnostic->message);
+		free(diagnostic);
+	}
+}
+
+static item_T *init_item()
+{
+	item_T *item = calloc(1, sizeof(item_T));
+	item->tokens = init_list(sizeof(token_T *));
+	item->lex_diagnostics = init_list(sizeof(diagnostic_T *));
+	item->parse_diagnostics = init_list(sizeof(diagnostic_T *));
+	item->declarations = init_list(sizeof(declaration_T *));
+	return item;
+}
+
+static void declarations_clear(list_T *declarations)
+{
+	declaration_T *declaration;
+	while ((declaration = list_pop(declarations))) free(declaration);
+}
+
+// declarations of item which is freed lose their names.
+static void declarations_hide(item_T *item)
+{
+	for (size_t i = 0; i < list_length(item->declarations); ++i)
+	{
+		declaration_T *declaration = list_get(item->declarations, i);
+		trie_value_T value = trie_find(symbol_trie_map, declaration->name);
+		if (value.is_value && (size_t)value.value.i32 == declaration->slot)
+			trie_delete(symbol_trie_map, declaration->name);
+
+		if (OWNER[declaration->slot] == item) OWNER[declaration->slot] = NULL;
+	}
+}
+
+// symbols which item declared stay in table, tree is leaked like trees of compile.
+static void item_free(item_T *item)
+{
+	for (size_t i = 0; i < list_length(item->tokens); ++i)
+	{
+		token_T *token = list_get(item->tokens, i);
+		free(token->value);
+		free(token);
+	}
+	list_free(item->tokens);
+
+	diagnostics_clear(item->lex_diagnostics);
+	list_free(item->lex_diagnostics);
+	diagnostics_clear(item->parse_diagnostics);
+	list_free(item->parse_diagnostics);
+	declarations_clear(item->declarations);
+	list_free(item->declarations);
+	free(item);
+}
+
+uint64_t item_line(item_T *item)
+{
+	token_T *token = list_get(item->tokens, 0);
+	return token->position.ln + item->moved;
+}
+
+// items which start at or before line
+static size_t items_before(list_T *items, uint64_t line)
+{
+	size_t low = 0, high = list_length(items);
+	while (low < high)
+	{
+		size_t mid = (low + high) / 2;
+		if (item_line(list_get(items, mid)) <= line) low = mid + 1;
+		else high = mid;
+	}
+
+	return low;
+}
+
+// parser looks up only names of tokens it parses, so declarations of items from `line` on are
+// hidden only from them. then parser sees just those which come before, like in compile.
+static void declarations_guard(list_T *tokens, uint64_t line)
+{
+	for (size_t i = 0; i < list_length(tokens); ++i)
+	{
+		token_T *token = list_get(tokens, i);
+		if (token->type != tt_ident) continue;
+
+		trie_value_T value = trie_find(symbol_trie_map, token->value);
+		if (!value.is_value) continue;
+
+		item_T *owner = OWNER[value.value.i32];
+		if (!owner || item_line(owner) < line) continue;
+
+		trie_delete(symbol_trie_map, token->value);
+		list_push(HIDDEN, &SYMBOLS[value.value.i32]);
+	}
+}
+
+// hidden declarations of items before `line` are shown again, unless their items were freed.
+static void declarations_reveal(uint64_t line)
+{
+	size_t kept = 0;
+	for (size_t i = 0; i < list_length(HIDDEN); ++i)
+	{
+		size_t slot = (symbol_T *)list_get(HIDDEN, i) - SYMBOLS;
+		if (OWNER[slot] && item_line(OWNER[slot]) >= line)
+		{
+			HIDDEN->buffer[kept++] = HIDDEN->buffer[i];
+			continue;
+		}
+
+		if (OWNER[slot] && !trie_find(symbol_trie_map, SYMBOLS[slot].name).is_value)
+			trie_insert(symbol_trie_map, SYMBOLS[slot].name, (trie_value_T){ .value.i32 = slot });
+	}
+	HIDDEN->index = kept;
+}
+
+// globals from `first` which statement declared, those which were already defined keep no name.
+static void declarations_record(item_T *item, uint64_t first)
+{
+	for (uint64_t slot = first; slot < GLOBAL_INDEX; ++slot)
+	{
+		trie_value_T value = trie_find(symbol_trie_map, SYMBOLS[slot].name);
+		if (!value.is_value || (uint64_t)value.value.i32 != slot) continue;
+
+		declaration_T *declaration = malloc(sizeof(declaration_T));
+		*declaration = (declaration_T){ .name = SYMBOLS[slot].name, .slot = slot };
+		list_push(item->declarations, declaration);
+		OWNER[slot] = item;
+	}
+}
+
+// what statements which use symbol see of it
+static uint64_t declaration_signature(declaration_T *declaration)
+{
+	symbol_T *symbol = &SYMBOLS[declaration->slot];
+	uint64_t hash = hash_bytes(&symbol->symb_s, sizeof(symbol->symb_s), HASH_SEED);
+	hash = hash_bytes(&symbol->data_type, sizeof(symbol->data_type), hash);
+	hash = hash_bytes(&symbol->u64, sizeof(symbol->u64), hash);
+
+	return hash_bytes(&symbol->is_const, sizeof(symbol->is_const), hash);
+}
+
+static declaration_T *declaration_find(list_T *declarations, const char *name)
+{
+	for (size_t i = 0; i < list_length(declarations); ++i)
+	{
+		declaration_T *declaration = list_get(declarations, i);
+		if (!strcmp(declaration->name, name)) return declaration;
+	}
+
+	return NULL;
+}
+
+// names which were declared, removed or declared differently are added to `changed`.
+static void declarations_compare(list_T *old, list_T *new, list_T *changed)
+{
+	for (size_t i = 0; i < list_length(old); ++i)
+	{
+		declaration_T *declaration = list_get(old, i);
+		declaration_T *other = declaration_find(new, declaration->name);
+		if (!other || declaration_signature(declaration) != declaration_signature(other))
+			list_push(changed, (void*)declaration->name);
+	}
+
+	for (size_t i = 0; i < list_length(new); ++i)
+	{
+		declaration_T *declaration = list_get(new, i);
+		if (!declaration_find(old, declaration->name))
+			list_push(changed, (void*)declaration->name);
+	}
+}
+
+static uint64_t name_bit(const char *name)
+{
+	return 1ull << (hash_bytes(name, strlen(name), HASH_SEED) & 63);
+}
+
+// `bits` are name_bit of names, items which have none of them are not searched.
+static bool item_mentions(item_T *item, list_T *names, uint64_t bits)
+{
+	if (!(item->names & bits)) return false;
+
+	for (size_t i = 0; i < list_length(item->tokens); ++i)
+	{
+		token_T *token = list_get(item->tokens, i);
+		if (token->type != tt_ident) continue;
+
+		for (size_t j = 0; j < list_length(names); ++j)
+			if (!strcmp(token->value, list_get(names, j))) return true;
+	}
+
+	return false;
+}
+
+// last line token is on, string may span lines (newlines it stands for are counted too).
+static uint64_t token_end_line(token_T *token)
+{
+	uint64_t line = token->position.ln;
+	if (token->type == tt_string)
+		for (const char *at = token->value; *at; ++at) line += *at == '\n';
+
+	return line;
+}
+
+// statements which start before `end` are parsed, each item gets those which start on one line.
+// `stop` is token at which last statement ended, it is past `end` if statement goes on. `reach`
+// is furthest token parser looked at, lines of tokens from `end` are moved by `moved`.
+static list_T *parse_items(list_T *tokens, size_t end, int64_t moved, size_t *stop, size_t *reach)
+{
+	list_T *items = init_list(sizeof(item_T *));
+	parser_T *parser = init_parser(tokens);
+	item_T *item = NULL;
+	uint64_t line = 0;
+
+	*reach = 0;
+	while ((size_t)parser->index < end && parser->token->type != tt_eof)
+	{
+		STATEMENT = parser->index;
+		if (!item || parser->token->position.ln > line)
+		{
+			item = init_item();
+			list_push(items, item);
+		}
+
+		uint64_t first_global = GLOBAL_INDEX, first_local = LOCAL_INDEX;
+		capture_begin(item->parse_diagnostics);
+		PARSER = parser;
+		parser->reach = parser->index;
+		ast_T *tree = parser_parse_item(parser);
+		capture_end();
+
+		size_t last = parser->reach > parser->index ? parser->reach : parser->index;
+		token_T *seen = list_get(tokens, last);
+		uint64_t seen_line = seen->position.ln + (last >= end ? moved : 0);
+		if (seen_line > item->reach) item->reach = seen_line;
+		if (last > *reach) *reach = last;
+
+		// locals of statement are not needed after it, their slots are used again.
+		LOCAL_INDEX = first_local;
+		declarations_record(item, first_global);
+
+		if (tree) item->tree = item->tree ? init_ast(ast_join, dnil, NULL, item->tree, NULL, tree, 0) : tree;
+
+		for (ssize_t i = STATEMENT; i < parser->index && (size_t)i < end; ++i)
+		{
+			token_T *token = list_get(tokens, i);
+			if (token->type == tt_ident) item->names |= name_bit(token->value);
+			list_push(item->tokens, token);
+		}
+
+		line = token_end_line(list_get(tokens, parser->index - 1));
+	}
+
+	*stop = parser->index;
+	list_free(parser->scope);
+	free(parser);
+
+	return items;
+}
+
+// tokens of lines [first, end) of text, `end` 0 is end of text. last token is eof.
+// `unclosed` is set when string goes on past them.
+static list_T *lex_lines(document_T *document, uint64_t first, uint64_t end, list_T *diagnostics, bool *unclosed)
+{
+	size_t from = 0, to = document->length;
+	uint64_t line = 1;
+	for (char *newline = document->text; (!end || line < end) &&
+		(newline = memchr(newline, '\n', document->length - (newline - document->text))); ++newline)
+	{
+		if (++line == first) from = newline - document->text + 1;
+		if (line == end) to = newline - document->text + 1;
+	}
+
+	char *text = strndup(document->text + from, to > from ? to - from : 0);
+	lexer_T *lexer = init_lexer_from_text(document->uri, text, (position_T){ .ln = first, .clm = 1, .len = 0 });
+
+	capture_begin(diagnostics);
+	LEXER = lexer;
+	list_T *tokens = lexer_get_tokens(lexer);
+	capture_end();
+	*unclosed = lexer->unclosed;
+
+	free(lexer->filename);
+	free(lexer);
+	free(text);
+
+	return tokens;
+}
+
+// tokens and errors of lexer of items [first, next) at lines they are on now, so they
+// are parsed again without text being lexed. last token is eof.
+static list_T *clone_items(list_T *items, size_t first, size_t next, list_T *diagnostics)
+{
+	list_T *tokens = init_list(sizeof(token_T *));
+	for (size_t i = first; i < next; ++i)
+	{
+		item_T *item = list_get(items, i);
+		for (size_t j = 0; j < list_length(item->tokens); ++j)
+		{
+			token_T *token = list_get(item->tokens, j);
+			position_T position = token->position;
+			position.ln += item->moved;
+			list_push(tokens, init_token(token->type, position, token->value));
+		}
+
+		for (size_t j = 0; j < list_length(item->lex_diagnostics); ++j)
+		{
+			diagnostic_T *diagnostic = malloc(sizeof(diagnostic_T));
+			*diagnostic = *(diagnostic_T *)list_get(item->lex_diagnostics, j);
+			diagnostic->line += item->moved;
+			diagnostic->message = strdup(diagnostic->message);
+			list_push(diagnostics, diagnostic);
+		}
+	}
+
+	list_push(tokens, init_token(tt_eof, (position_T){ 0 }, ""));
+	return tokens;
+}
+
+// errors of lexer go to item whose lines they are on.
+static void distribute_diagnostics(list_T *items, list_T *diagnostics)
+{
+	diagnostic_T *diagnostic;
+	while ((diagnostic = list_pop(diagnostics)))
+	{
+		size_t index = items_before(items, diagnostic->line);
+		if (!list_length(items))
+		{
+			free(diagnostic->message);
+			free(diagnostic);
+			continue;
+		}
+
+		item_T *item = list_get(items, index ? index - 1 : 0);
+		list_push(item->lex_diagnostics, diagnostic);
+	}
+	list_free(diagnostics);
+}
+
+// position of eof token of whole text
+static position_T document_end(document_T *document)
+{
+	position_T position = { .ln = 1, .clm = 1, .len = 0 };
+	for (size_t i = 0; i < document->length; ++i)
+	{
+		if (document->text[i] == '\n') position.ln++, position.clm = 1;
+		else position.clm++;
+	}
+
+	return position;
+}
+
+// items [first, next) are parsed again, from text which starts at `first_line` when `relex`
+// is set and from tokens they have otherwise. names whose declarations changed are added
+// to `changed`, returns number of items which replaced them.
+static size_t document_rebuild(document_T *document, size_t first, size_t next,
+	uint64_t first_line, bool relex, list_T *changed)
+{
+	list_T *items = document->items;
+	size_t length = list_length(items);
+	if (!relex) first_line = item_line(list_get(items, first));
+
+	list_T *fresh;
+	size_t step = 0;
+	while (true)
+	{
+		list_T *diagnostics = init_list(sizeof(diagnostic_T *));
+		bool unclosed = false;
+		list_T *tokens = relex ?
+			lex_lines(document, first_line, next < length ? item_line(list_get(items, next)) : 0, diagnostics, &unclosed) :
+			clone_items(items, first, next, diagnostics);
+		token_T *eof = list_pop(tokens);
+		size_t region = list_length(tokens);
+
+		// tokens of next item follow, so last statement ends where it would in whole text.
+		int64_t moved = 0;
+		if (next < length)
+		{
+			item_T *following = list_get(items, next);
+			list_extend(tokens, following->tokens);
+			moved = following->moved;
+		}
+		else eof->position = document_end(document);
+		list_push(tokens, eof);
+		declarations_guard(tokens, first_line);
+
+		size_t stop, reach;
+		fresh = parse_items(tokens, region, moved, &stop, &reach);
+		distribute_diagnostics(fresh, diagnostics);
+		free(eof->value);
+		free(eof);
+
+		// parser which looked at eof would have seen tokens of items after next one.
+		bool ended = stop <= region && reach + 1 < list_length(tokens) && !unclosed;
+		if (ended || next >= length)
+		{
+			list_free(tokens);
+			break;
+		}
+
+		// statement or string goes on into next item (or further), so it is parsed with it.
+		for (size_t i = 0; i < list_length(fresh); ++i)
+		{
+			declarations_hide(list_get(fresh, i));
+			item_free(list_get(fresh, i));
+		}
+		list_free(fresh);
+		list_free(tokens);
+
+		step = step ? step * 2 : 1;
+		next = next + step < length ? next + step : length;
+	}
+
+	list_T *old_declarations = init_list(sizeof(declaration_T *));
+	for (size_t i = first; i < next; ++i)
+		list_extend(old_declarations, ((item_T *)list_get(items, i))->declarations);
+
+	list_T *new_declarations = init_list(sizeof(declaration_T *));
+	for (size_t i = 0; i < list_length(fresh); ++i)
+		list_extend(new_declarations, ((item_T *)list_get(fresh, i))->declarations);
+
+	declarations_compare(old_declarations, new_declarations, changed);
+	list_free(old_declarations);
+	list_free(new_declarations);
+
+	// items are replaced in place, old ones are freed after.
+	size_t count = list_length(fresh);
+	for (size_t i = first; i < next; ++i) list_push(fresh, list_get(items, i));
+	// list grows by pushing, pushed items are overwritten when others are moved.
+	while (list_length(items) < length - (next - first) + count) list_push(items, list_get(fresh, 0));
+	memmove(items->buffer + first + count, items->buffer + next, (length - next) * sizeof(void *));
+	memcpy(items->buffer + first, fresh->buffer, count * sizeof(void *));
+	items->index = length - (next - first) + count;
+
+	for (size_t i = count; i < list_length(fresh); ++i)
+	{
+		declarations_hide(list_get(fresh, i));
+		item_free(list_get(fresh, i));
+	}
+	list_free(fresh);
+
+	return count;
+}
+
+// items [first, next) are replaced with those of their lines, which start at `first_line`.
+// later items which refer to symbol whose declaration changed are parsed again, in order.
+static void document_reparse(document_T *document, size_t first, size_t next, uint64_t first_line)
+{
+	list_T *changed = init_list(sizeof(char *));
+	size_t index = first + document_rebuild(document, first, next, first_line, true, changed);
+	document->reparsed = index - first;
+
+	uint64_t bits = 0;
+	size_t names = 0;
+	// names are only added by items parsed here, without any there is nothing to look for
+	while (list_length(changed) && index < list_length(document->items))
+	{
+		for (; names < list_length(changed); ++names) bits |= name_bit(list_get(changed, names));
+
+		item_T *item = list_get(document->items, index);
+		if (!item_mentions(item, changed, bits))
+		{
+			index++;
+			continue;
+		}
+
+		declarations_reveal(item_line(item));
+		size_t count = document_rebuild(document, index, index + 1, 0, false, changed);
+		document->reparsed += count;
+		index += count;
+	}
+
+	declarations_reveal(UINT64_MAX);
+	list_free(changed);
+}
+
+// symbols of replaced items are never reused, so table is built again when it fills up.
+static void symbols_reset()
+{
+	symbol_trie_map = init_trie_node();
+	GLOBAL_INDEX = 0;
+	LOCAL_INDEX = SYMBOL_SIZE - 1;
+	memset(FUNCTIONS, 0, SYMBOL_SIZE * sizeof(ast_T *));
+
+	if (!OWNER)
+	{
+		OWNER = malloc(SYMBOL_SIZE * sizeof(item_T *));
+		HIDDEN = init_list(sizeof(symbol_T *));
+	}
+	memset(OWNER, 0, SYMBOL_SIZE * sizeof(item_T *));
+	HIDDEN->index = 0;
+}
+
+static void document_parse_all(document_T *document)
+{
+	symbols_reset();
+	ACTIVE = document;
+
+	for (size_t i = 0; i < list_length(document->items); ++i)
+		item_free(list_get(document->items, i));
+	document->items->index = 0;
+	diagnostics_clear(document->diagnostics);
+
+	// imported modules are read from disk, main module is last and is replaced by text.
+	// document which was never saved imports nothing.
+	if (document->path && !access(document->path, R_OK))
+	{
+		capture_begin(document->diagnostics);
+		list_T *modules = load_modules(document->path, 1);
+		for (size_t i = 0; modules && i + 1 < list_length(modules); ++i)
+			module_parse(list_get(modules, i));
+		capture_end();
+	}
+
+	document_reparse(document, 0, 0, 1);
+}
+
+static void document_splice(document_T *document, size_t start, size_t end, const char *text)
+{
+	size_t length = strlen(text);
+	size_t new_length = document->length - (end - start) + length;
+	if (new_length + 1 > document->capacity)
+	{
+		document->capacity = (new_length + 1) * 2;
+		document->text = realloc(document->text, document->capacity);
+	}
+
+	memmove(document->text + start + length, document->text + end, document->length - end + 1);
+	memcpy(document->text + start, text, length);
+	document->length = new_length;
+}
+
+// offset of position, positions past end of line or text are clamped.
+static size_t document_offset(document_T *document, uint64_t line, uint64_t character)
+{
+	size_t offset = 0;
+	for (char *newline; line && (newline = memchr(document->text + offset, '\n', document->length - offset)); --line)
+		offset = newline - document->text + 1;
+	if (line) offset = document->length;
+
+	for (; character && offset < document->length && document->text[offset] != '\n'; --character)
+		offset++;
+
+	return offset;
+}
+
+static int64_t count_lines(const char *text, size_t length)
+{
+	int64_t lines = 0;
+	for (size_t i = 0; i < length; ++i) lines += text[i] == '\n';
+
+	return lines;
+}
+
+document_T *init_document(const char *uri, const char *path, const char *text)
+{
+	document_T *document = calloc(1, sizeof(document_T));
+	document->uri = strdup(uri);
+	document->path = path ? strdup(path) : NULL;
+	document->length = strlen(text);
+	document->capacity = document->length + 1;
+	document->text = strdup(text);
+	document->items = init_list(sizeof(item_T *));
+	document->diagnostics = init_list(sizeof(diagnostic_T *));
+
+	document_parse_all(document);
+	return document;
+}
+
+void document_free(document_T *document)
+{
+	if (ACTIVE == document) ACTIVE = NULL;
+
+	for (size_t i = 0; i < list_length(document->items); ++i)
+		item_free(list_get(document->items, i));
+	list_free(document->items);
+	diagnostics_clear(document->diagnostics);
+	list_free(document->diagnostics);
+
+	free(document->uri);
+	free(document->path);
+	free(document->text);
+	free(document);
+}
+
+void document_edit(document_T *document,
+	uint64_t start_line, uint64_t start_character,
+	uint64_t end_line, uint64_t end_character, const char *text)
+{
+	size_t start = document_offset(document, start_line, start_character);
+	size_t end = document_offset(document, end_line, end_character);
+	if (end < start) end = start;
+
+	int64_t delta = count_lines(text, strlen(text)) - count_lines(document->text + start, end - start);
+	document_splice(document, start, end, text);
+
+	if (ACTIVE != document || GLOBAL_INDEX >= SYMBOL_SIZE / 2)
+	{
+		document_parse_all(document);
+		return;
+	}
+
+	// items before edited ones are parsed too if parser looked at edited lines, statement
+	// in them may go on into them or its meaning may depend on them.
+	list_T *items = document->items;
+	size_t length = list_length(items), first = 0;
+	while (first + 1 < length &&
+			((item_T *)list_get(items, first))->reach + ((item_T *)list_get(items, first))->moved <= start_line)
+		first++;
+	size_t next = items_before(items, end_line + 1);
+	if (next < first) next = first;
+	uint64_t first_line = first ? item_line(list_get(items, first)) : 1;
+
+	for (size_t i = next; i < list_length(items); ++i)
+		((item_T *)list_get(items, i))->moved += delta;
+
+	document_reparse(document, first, next, first_line);
+}
+
+void document_replace(document_T *document, const char *text)
+{
+	free(document->text);
+	document->length = strlen(text);
+	document->capacity = document->length + 1;
+	document->text = strdup(text);
+
+	document_parse_all(document);
+}
+
+static ast_T *node_of_token(ast_T *root, token_T *token)
+{
+	if (!root) return NULL;
+	if (root->token == token) return root;
+
+	ast_T *found = node_of_token(root->left, token);
+	if (!found) found = node_of_token(root->mid, token);
+
+	return found ? found : node_of_token(root->right, token);
+}
+
+// data types are named like `di64`.
+static const char *type_name(data_type_T data_type)
+{
+	const char *name = data_type_to_string(data_type);
+	return name[0] == 'd' ? name + 1 : name;
+}
+
+char *document_describe(document_T *document, uint64_t line, uint64_t character)
+{
+	size_t index = items_before(document->items, line + 1);
+	if (!index) return NULL;
+
+	item_T *item = list_get(document->items, index - 1);
+	for (size_t i = 0; i < list_length(item->tokens); ++i)
+	{
+		token_T *token = list_get(item->tokens, i);
+		uint64_t width = strlen(token->value) ? strlen(token->value) : 1;
+		if (token->position.ln + item->moved != line + 1 ||
+				character + 1 < token->position.clm || character + 1 >= token->position.clm + width)
+			continue;
+
+		ast_T *node = node_of_token(item->tree, token);
+		if (!node) return NULL;
+
+		switch (node->type)
+		{
+			case ast_function:
+			{
+				list_T *params = init_list(sizeof(ast_T *));
+				flatten_join(node->mid, params);
+
+				char *text = formate_string("%s(", token->value);
+				for (size_t j = 0; j < list_length(params); ++j)
+				{
+					ast_T *param = list_get(params, j);
+					text = strjoin(text, formate_string("%s%s: %s",
+						j ? ", " : "", param->token->value, type_name(param->data_type)));
+				}
+				list_free(params);
+
+				return strjoin(text, formate_string("): %s", type_name(node->data_type)));
+			}
+			case ast_call: return formate_string("%s(...): %s", token->value, type_name(node->data_type));
+			case ast_ident:
+			case ast_assign:
+			case ast_alloca: return formate_string("%s: %s", token->value, type_name(node->data_type));
+			default: return NULL;
+		}
+	}
+
+	return NULL;
+}
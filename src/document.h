@@ -0,0 +1,76 @@
+#ifndef __document_h__
+#define __document_h__
+
+#include "glob.h"
+#include "list.h"
+#include "lexer.h"
+#include "parser.h"
+
+// message which compiler printed while document was lexed or parsed,
+// lines and columns count from 1 like positions of tokens
+typedef struct {
+	uint64_t line;
+	uint64_t column;
+	uint64_t length;
+	bool is_warning;
+	char *message;
+} diagnostic_T;
+
+// global symbol which item declared
+typedef struct {
+	const char *name;
+	size_t slot;
+} declaration_T;
+
+// statements of top level, all which start on same line are in one item. item owns lines
+// from its first token up to first line of next item, so text is edited by whole items.
+// positions of its tokens and diagnostics are from time it was lexed, `moved` is added to their lines.
+typedef struct {
+	list_T *tokens;
+	int64_t moved;
+	// last line parser looked at while it parsed item, item is parsed again when it is edited
+	uint64_t reach;
+	// bit of hash of every identifier in item, see item_mentions in document.c
+	uint64_t names;
+	ast_T *tree;
+	list_T *lex_diagnostics;
+	list_T *parse_diagnostics;
+	list_T *declarations;
+} item_T;
+
+typedef struct {
+	char *uri;
+	// file of document, its imports are resolved from it. NULL if there is none
+	char *path;
+	char *text;
+	size_t length;
+	size_t capacity;
+	list_T *items;
+	// diagnostics of modules which document imports
+	list_T *diagnostics;
+	// items which last change parsed
+	size_t reparsed;
+} document_T;
+
+// document is lexed and parsed as whole, `path` may be NULL.
+document_T *init_document(const char *uri, const char *path, const char *text);
+void document_free(document_T *document);
+
+// replaces text between two positions (lines and characters count from 0, characters are bytes).
+// items from first one which parser looked at edited lines for up to last edited one are lexed and
+// parsed again, so are items after them when statement goes on into them. other items keep their
+// trees, only those which refer to symbol whose declaration has changed are parsed again (from tokens they have).
+void document_edit(document_T *document,
+	uint64_t start_line, uint64_t start_character,
+	uint64_t end_line, uint64_t end_character, const char *text);
+
+// whole text is replaced, imports are resolved again and everything is parsed.
+void document_replace(document_T *document, const char *text);
+
+// line of item in current text
+uint64_t item_line(item_T *item);
+
+// description of symbol at position (counted from 0), NULL if there is no symbol.
+char *document_describe(document_T *document, uint64_t line, uint64_t character);
+
+#endif // __document_h__
@@ -0,0 +1,188 @@
+#include "escape.h"
+
+static uint64_t count_assigns(ast_T *root, size_t slot)
+{
+	if (!root) return 0;
+
+	return
+		(root->type == ast_assign && root->index == slot) +
+		count_assigns(root->left, slot) +
+		count_assigns(root->mid, slot) +
+		count_assigns(root->right, slot);
+}
+
+static bool is_pointer(ast_T *root, size_t slot)
+{
+	return root && root->type == ast_ident && root->index == slot;
+}
+
+static bool is_free(ast_T *root, size_t slot)
+{
+	return root->type == ast_call && !strcmp(root->token->value, "free") && is_pointer(root->left, slot);
+}
+
+// pointer escapes if it is used in any other way than
+// `$(p, i)`, `free(p)` or compared.
+static bool escapes(ast_T *root, size_t slot, ast_T *allocation)
+{
+	if (!root) return false;
+
+	if (is_pointer(root, slot)) return true;
+	if (root->type == ast_assign && root->index == slot && root != allocation) return true;
+	if (is_free(root, slot)) return false;
+
+	if (root->type == ast_deref && is_pointer(root->left, slot))
+		return escapes(root->right, slot, allocation);
+
+	if (is_comparison(root->type))
+		return
+			(!is_pointer(root->left, slot) && escapes(root->left, slot, allocation)) ||
+			(!is_pointer(root->right, slot) && escapes(root->right, slot, allocation));
+
+	return
+		escapes(root->left, slot, allocation) ||
+		escapes(root->mid, slot, allocation) ||
+		escapes(root->right, slot, allocation);
+}
+
+static ast_T *const_leaf(position_T position, int64_t value)
+{
+	return init_ast_leaf(ast_const, dnil, init_token(tt_const_int, position, formate_string("%ld", value)), 0);
+}
+
+static size_t declare_buffer(ast_T *allocation)
+{
+	symbol_T symbol = { 0 };
+	symbol.symb_s = SVAR;
+	symbol.symb_c = CLOCAL;
+	symbol.name = formate_string("%s.buffer", allocation->token->value);
+	symbol.data_type = dptr;
+	symbol.arg_reg = symbol.arg_stack = -1;
+
+	return init_locl_symb(symbol);
+}
+
+static ast_T *buffer_address(ast_T *call, size_t buffer, uint64_t size)
+{
+	return init_ast(ast_alloca, dptr, call->token, const_leaf(call->token->position, size), NULL, NULL, buffer);
+}
+
+// `free(p)` of fixed buffer is removed, of bounded one is done only if it went to heap.
+static ast_T *rewrite_free(ast_T *root, size_t slot, ast_T *buffer)
+{
+	if (!root) return NULL;
+
+	if (is_free(root, slot))
+	{
+		if (!buffer) return NULL;
+
+		ast_T *cond = init_ast(
+			ast_neq, di32, init_token(tt_neq, root->token->position, "!="),
+			ast_clone(root->left), NULL, buffer, 0
+		);
+
+		return init_ast(ast_if, dnil, root->token, cond, root, NULL, 0);
+	}
+
+	root->left = rewrite_free(root->left, slot, buffer);
+	root->mid = rewrite_free(root->mid, slot, buffer);
+	root->right = rewrite_free(root->right, slot, buffer);
+
+	return root;
+}
+
+static ast_T *replace(ast_T *root, ast_T *from, ast_T *to)
+{
+	if (!root) return NULL;
+	if (root == from) return to;
+
+	root->left = replace(root->left, from, to);
+	root->mid = replace(root->mid, from, to);
+	root->right = replace(root->right, from, to);
+
+	return root;
+}
+
+static void collect_allocations(ast_T *root, list_T *allocations)
+{
+	if (!root) return;
+
+	if (
+			root->type == ast_assign && root->left &&
+			root->left->type == ast_call && is_allocation(root->left->token->value) &&
+			SYMBOLS[root->index].symb_c == CLOCAL
+		 ) list_push(allocations, root);
+
+	collect_allocations(root->left, allocations);
+	collect_allocations(root->mid, allocations);
+	collect_allocations(root->right, allocations);
+}
+
+static ast_T *escape_function(ast_T *function)
+{
+	list_T *allocations = init_list(sizeof(ast_T *));
+	collect_allocations(function->left, allocations);
+
+	for (size_t i = 0; i < list_length(allocations); ++i)
+	{
+		ast_T *allocation = list_get(allocations, i);
+		ast_T *call = allocation->left;
+		ast_T *size = call->left;
+		size_t slot = allocation->index;
+
+		if (!size || size->type == ast_join) continue;
+		if (count_assigns(function->left, slot) != 1) continue;
+		if (escapes(function->left, slot, allocation)) continue;
+
+		if (size->type == ast_const && size->token->type == tt_const_int)
+		{
+			int64_t bytes = strtoll(size->token->value, NULL, 10);
+			if (bytes <= 0 || bytes > ESCAPE_STACK_LIMIT) continue;
+
+			// p = alloc(n) -> p = &buffer
+			allocation->left = buffer_address(call, declare_buffer(allocation), (bytes + 7) / 8 * 8);
+			function->left = rewrite_free(function->left, slot, NULL);
+			continue;
+		}
+
+		// size is evaluated twice, so it cannot have side effects.
+		if (ast_contains(size, ast_call) || size->data_type == dstr) continue;
+
+		// p = alloc(n) -> if (n <= N) p = &buffer; else p = alloc(n);
+		size_t buffer = declare_buffer(allocation);
+		position_T position = call->token->position;
+
+		ast_T *cond = init_ast(
+			ast_lte, di32, init_token(tt_lte, position, "<="),
+			ast_clone(size), NULL, const_leaf(position, ESCAPE_BUFFER_SIZE), 0
+		);
+		ast_T *stack = init_ast_unary(ast_assign, allocation->data_type, allocation->token,
+			buffer_address(call, buffer, ESCAPE_BUFFER_SIZE), slot);
+		ast_T *branch = init_ast(ast_if, dnil, call->token, cond, stack, allocation, 0);
+
+		function->left = replace(function->left, allocation, branch);
+		function->left = rewrite_free(function->left, slot, buffer_address(call, buffer, ESCAPE_BUFFER_SIZE));
+	}
+
+	list_free(allocations);
+	return function;
+}
+
+ast_T *escape_allocations(ast_T *root)
+{
+	list_T *functions = init_list(sizeof(ast_T *));
+	flatten_join(root, functions);
+
+	for (size_t i = 0; i < list_length(functions); ++i)
+	{
+		ast_T *function = list_get(functions, i);
+		if (!function || function->type != ast_function) continue;
+
+		report_begin_function(function->token->value);
+		escape_function(function);
+		report_end();
+	}
+
+	list_free(functions);
+	return root;
+}
@@ -0,0 +1,18 @@
+#ifndef __escape_h__
+#define __escape_h__
+
+#include "glob.h"
+#include "parser.h"
+#include "report.h"
+
+// max size (in bytes) of fixed allocation that is moved into stack frame
+#define ESCAPE_STACK_LIMIT 1024
+
+// size of stack buffer which is used by variable sized allocation,
+// larger allocations still go to heap
+#define ESCAPE_BUFFER_SIZE 256
+
+// put allocations which do not outlive their function into stack frame
+ast_T *escape_allocations(ast_T *root);
+
+#endif // __escape_h__
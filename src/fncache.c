@@ -0,0 +1,193 @@
+#include "fncache.h"
+#include "cache.h"
+#include <unistd.h>
+
+// part of file which is not read yet
+typedef struct {
+	char *at;
+	char *end;
+} reader_T;
+
+static bool read_value(reader_T *reader, void *value, size_t size)
+{
+	if ((size_t)(reader->end - reader->at) < size) return false;
+
+	memcpy(value, reader->at, size);
+	reader->at += size;
+
+	return true;
+}
+
+// strings point into buffer of file, which is kept for whole compile.
+static const char *read_string(reader_T *reader)
+{
+	char *end = memchr(reader->at, '\0', reader->end - reader->at);
+	if (!end) return NULL;
+
+	const char *string = reader->at;
+	reader->at = end + 1;
+
+	return string;
+}
+
+static fncache_entry_T *read_entry(reader_T *reader)
+{
+	uint64_t fingerprint;
+	uint32_t externs, literals;
+	if (!read_value(reader, &fingerprint, sizeof(fingerprint)) ||
+			!read_value(reader, &externs, sizeof(externs)) ||
+			!read_value(reader, &literals, sizeof(literals)))
+		return NULL;
+
+	fncache_entry_T *entry = malloc(sizeof(fncache_entry_T));
+	*entry = (fncache_entry_T){
+		.fingerprint = fingerprint,
+		.text = read_string(reader),
+		.externs = init_list(sizeof(char *)),
+		.literals = init_list(sizeof(literal_use_T *))
+	};
+	if (!entry->text) return NULL;
+
+	for (uint32_t i = 0; i < externs; ++i)
+	{
+		const char *name = read_string(reader);
+		if (!name) return NULL;
+		list_push(entry->externs, (void*)name);
+	}
+
+	for (uint32_t i = 0; i < literals; ++i)
+	{
+		uint8_t needs_length;
+		const char *text;
+		if (!read_value(reader, &needs_length, sizeof(needs_length)) || !(text = read_string(reader)))
+			return NULL;
+
+		literal_use_T *literal = malloc(sizeof(literal_use_T));
+		*literal = (literal_use_T){ .text = text, .needs_length = needs_length };
+		list_push(entry->literals, literal);
+	}
+
+	return entry;
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+	const fncache_entry_T *x = *(fncache_entry_T *const *)a, *y = *(fncache_entry_T *const *)b;
+
+	return (x->fingerprint > y->fingerprint) - (x->fingerprint < y->fingerprint);
+}
+
+list_T *fncache_load(const char *output)
+{
+	list_T *entries = init_list(sizeof(fncache_entry_T *));
+
+	char *path = formate_string("%s%s", output, FNCACHE_EXTENSION);
+	FILE *file = fopen(path, "rb");
+	free(path);
+	if (!file) return entries;
+
+	fseek(file, 0, SEEK_END);
+	long size = ftell(file);
+	rewind(file);
+
+	char *data = size > 0 ? malloc(size) : NULL;
+	bool success = data && fread(data, 1, size, file) == (size_t)size;
+	fclose(file);
+
+	fncache_header_T header;
+	reader_T reader = { .at = data, .end = data + (success ? size : 0) };
+	success = success &&
+		read_value(&reader, &header, sizeof(header)) &&
+		header.magic == FNCACHE_MAGIC &&
+		header.version == FNCACHE_VERSION &&
+		header.compiler == cache_compiler_hash();
+
+	for (uint64_t i = 0; success && i < header.entries; ++i)
+	{
+		fncache_entry_T *entry = read_entry(&reader);
+		if (entry) list_push(entries, entry);
+		else success = false;
+	}
+
+	// damaged file is ignored as whole, it is replaced after compile.
+	if (!success)
+	{
+		entries->index = 0;
+		free(data);
+		return entries;
+	}
+
+	qsort(entries->buffer, list_length(entries), sizeof(void *), compare_entries);
+	return entries;
+}
+
+fncache_entry_T *fncache_find(list_T *entries, uint64_t fingerprint)
+{
+	fncache_entry_T key = { .fingerprint = fingerprint }, *pointer = &key;
+	fncache_entry_T **found = bsearch(&pointer, entries->buffer, list_length(entries),
+		sizeof(void *), compare_entries);
+
+	return found ? *found : NULL;
+}
+
+static bool write_string(FILE *file, const char *string)
+{
+	return fwrite(string, 1, strlen(string) + 1, file) == strlen(string) + 1;
+}
+
+static bool write_entry(FILE *file, fncache_entry_T *entry)
+{
+	uint32_t externs = list_length(entry->externs), literals = list_length(entry->literals);
+	bool success =
+		fwrite(&entry->fingerprint, sizeof(entry->fingerprint), 1, file) == 1 &&
+		fwrite(&externs, sizeof(externs), 1, file) == 1 &&
+		fwrite(&literals, sizeof(literals), 1, file) == 1 &&
+		write_string(file, entry->text);
+
+	for (uint32_t i = 0; success && i < externs; ++i)
+		success = write_string(file, list_get(entry->externs, i));
+
+	for (uint32_t i = 0; success && i < literals; ++i)
+	{
+		literal_use_T *literal = list_get(entry->literals, i);
+		uint8_t needs_length = literal->needs_length;
+		success = fwrite(&needs_length, 1, 1, file) == 1 && write_string(file, literal->text);
+	}
+
+	return success;
+}
+
+void fncache_store(const char *output, list_T *entries)
+{
+	char *path = formate_string("%s%s", output, FNCACHE_EXTENSION);
+	char *temporary = formate_string("%s.%d.tmp", path, getpid());
+
+	FILE *file = fopen(temporary, "wb");
+	if (!file)
+	{
+		printf("warn :: failed to write code of functions to `%s`.\n", path);
+		free(temporary);
+		free(path);
+		return;
+	}
+
+	fncache_header_T header = {
+		.magic = FNCACHE_MAGIC,
+		.version = FNCACHE_VERSION,
+		.compiler = cache_compiler_hash(),
+		.entries = list_length(entries)
+	};
+	bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+	for (size_t i = 0; success && i < list_length(entries); ++i)
+		success = write_entry(file, list_get(entries, i));
+
+	success &= !fclose(file);
+	if (!success || rename(temporary, path))
+	{
+		printf("warn :: failed to write code of functions to `%s`.\n", path);
+		unlink(temporary);
+	}
+
+	free(temporary);
+	free(path);
+}
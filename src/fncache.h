@@ -0,0 +1,52 @@
+#ifndef __fncache_h__
+#define __fncache_h__
+
+#include "glob.h"
+#include "list.h"
+
+// code of functions is kept next to output, `out.asm` -> `out.asm.fns`
+#define FNCACHE_EXTENSION ".fns"
+
+#define FNCACHE_MAGIC 0x534e4654 // "TFNS"
+// bumped whenever layout of file changes
+#define FNCACHE_VERSION 1
+
+// file is header followed by entries, every entry is its fingerprint, counts of its
+// externs and literals and then zero terminated text, externs and literals.
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	// entries of another compiler are not used, see cache_compiler_hash
+	uint64_t compiler;
+	uint64_t entries;
+} fncache_header_T;
+
+// literal which code of function uses, it is added to pool again when code is reused
+typedef struct {
+	const char *text;
+	bool needs_length;
+} literal_use_T;
+
+// generated code of one function
+typedef struct {
+	// hash of everything code depends on, see fingerprint_function in asmgen
+	uint64_t fingerprint;
+	const char *text;
+	// externs which code calls, in order they were first used
+	list_T *externs;
+	// literal_use_T *
+	list_T *literals;
+} fncache_entry_T;
+
+// entries which were stored for `output`, sorted by fingerprint. empty when
+// there are none, they are damaged or they were written by another compiler.
+list_T *fncache_load(const char *output);
+
+// entry with fingerprint, NULL if there is none.
+fncache_entry_T *fncache_find(list_T *entries, uint64_t fingerprint);
+
+// replaces entries of `output`. file is written under temporary name and renamed,
+// so compile which reads it meanwhile sees either old or new entries.
+void fncache_store(const char *output, list_T *entries);
+
+#endif // __fncache_h__
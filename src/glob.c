@@ -15,15 +15,16 @@ char *__formate_string_function__(char *s, ...)
 	va_list ap;
 	va_start(ap, s);
 
-	size_t nSize = vsnprintf(buffer, buffer_size, s, ap);
+	int nSize = vsnprintf(buffer, buffer_size, s, ap);
 	if (nSize < 0)
 	{
 		free(buffer);
 		va_end(ap);
+		return NULL;
 	}
 
 	// if buffer does not have enough space then extend it.
-	if (nSize >= buffer_size)
+	if ((size_t)nSize >= buffer_size)
 	{
 		buffer_size = nSize + 1;
 		buffer = (char*)realloc(buffer, buffer_size);
@@ -76,11 +77,23 @@ char *strreplace(char *s, unsigned char from, unsigned char to)
 	return s;
 }
 
+uint64_t hash_bytes(const void *data, size_t length, uint64_t hash)
+{
+	const unsigned char *bytes = data;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
 size_t init_glob_symb(symbol_T symbol)
 {
 	if (GLOBAL_INDEX >= LOCAL_INDEX)
 	{
-		printf("err :: cannot store more global symbol.\n");
+		compile_error("err :: cannot store more global symbol.\n");
 		return 0;
 	}
 
@@ -93,7 +106,7 @@ size_t init_locl_symb(symbol_T symbol)
 {
 	if (LOCAL_INDEX <= GLOBAL_INDEX)
 	{
-		printf("err :: cannot store more local symbol.\n");
+		compile_error("err :: cannot store more local symbol.\n");
 		return 0;
 	}
 
@@ -104,7 +117,7 @@ size_t init_locl_symb(symbol_T symbol)
 
 const char *data_type_to_string(data_type_T data_type)
 {
-	char *v;
+	char *v = "unknown";
 
 	switch (data_type)
 	{
@@ -122,6 +135,7 @@ const char *data_type_to_string(data_type_T data_type)
 		case du64: v = "du64"; break;
 		case df32: v = "df32"; break;
 		case df64: v = "df64"; break;
+		case dptr: v = "dptr"; break;
 	}
 
 	return v;
@@ -146,7 +160,7 @@ data_type_T token_type_to_data_type(token_type_T token_type)
 		case tt_f64: return df64;
 		default:
 		{
-			printf("err :: unrecognised data type found.\n");
+			compile_error("err :: unrecognised data type found.\n");
 			return dnil;
 		}
 	}
@@ -173,22 +187,125 @@ uint8_t get_data_type_size(data_type_T data_type)
 		case di64:
 		case du64:
 		case df64:
+		case dptr:
 		case dstr: 		return 8;
 	}
+
+	return 0;
+}
+
+bool is_signed_data_type(data_type_T data_type)
+{
+	switch (data_type)
+	{
+		case dchar:
+		case di8:
+		case di16:
+		case di32:
+		case di64: 	return true;
+		default: 		return false;
+	}
+}
+
+bool is_float_data_type(data_type_T data_type)
+{
+	return data_type == df32 || data_type == df64;
+}
+
+bool is_comparison(ast_type_T type)
+{
+	switch (type)
+	{
+		case ast_lt:
+		case ast_lte:
+		case ast_gt:
+		case ast_gte:
+		case ast_eq:
+		case ast_neq: return true;
+		default: 			return false;
+	}
+}
+
+ast_type_T comparison_inverse(ast_type_T type)
+{
+	switch (type)
+	{
+		case ast_lt: 	return ast_gte;
+		case ast_lte: return ast_gt;
+		case ast_gt: 	return ast_lte;
+		case ast_gte: return ast_lt;
+		case ast_eq: 	return ast_neq;
+		case ast_neq: return ast_eq;
+		default: return type;
+	}
+}
+
+// comparison with swapped operands, `a < b` is `b > a`.
+ast_type_T comparison_mirror(ast_type_T type)
+{
+	switch (type)
+	{
+		case ast_lt: 	return ast_gt;
+		case ast_lte: return ast_gte;
+		case ast_gt: 	return ast_lt;
+		case ast_gte: return ast_lte;
+		default: return type;
+	}
+}
+
+// return type of runtime functions which are not declared in program.
+data_type_T builtin_data_type(const char *name)
+{
+	if (is_allocation(name)) return dptr;
+	if (!strcmp(name, "free") || !strcmp(name, "print") || !strcmp(name, "exit")) return dvoid;
+
+	return dnil;
+}
+
+// name of runtime symbol which is called for builtin.
+const char *builtin_symbol(const char *name)
+{
+	if (is_allocation(name)) return "tl_alloc";
+	if (!strcmp(name, "free")) return "tl_free";
+	if (!strcmp(name, "print")) return "tl_print";
+	if (!strcmp(name, "printf")) return "tl_printf";
+	if (!strcmp(name, "putchar")) return "tl_putchar";
+	if (!strcmp(name, "exit")) return "tl_exit";
+
+	return name;
+}
+
+bool is_allocation(const char *name)
+{
+	return !strcmp(name, "alloc") || !strcmp(name, "memalloc");
 }
 
 data_type_T type_check(ast_type_T operation, data_type_T left, data_type_T right)
 {
 	switch (operation)
 	{
+		case ast_lt:
+		case ast_lte:
+		case ast_gt:
+		case ast_gte:
+		case ast_eq:
+		case ast_neq:
+		{
+			if (left == dstr || right == dstr)
+				compile_error("err :: cannot compare strings.\n");
+
+			// result of comparison is 0 or 1.
+			return di32;
+		}
 		case ast_add:
 		case ast_sub:
 		case ast_mul:
 		case ast_div:
+		case ast_mod:
 		{
 			if (left == dstr || right == dstr)
 			{
-				printf("err :: cannot do (+, -, *, /) on string.\n");
+				compile_error("err :: cannot do (+, -, *, /, %%) on string.\n");
 				return dstr;
 			}
 
@@ -203,11 +320,11 @@ data_type_T type_check(ast_type_T operation, data_type_T left, data_type_T right
 			else if (left != right)
 			{
 				if (
-						left == dstr && right != dstr ||
-						left != dstr && right == dstr
+						(left == dstr && right != dstr) ||
+						(left != dstr && right == dstr)
 						)
 				{
-					printf("err :: %s must have same type as %s type.\n",
+					compile_error("err :: %s must have same type as %s type.\n",
 							operation == ast_function ? "return" : "expr",
 							operation == ast_function ? "function" : "variable"
 							);
@@ -25,7 +25,8 @@ typedef enum {
 	du32,
 	du64,
 	df32,
-	df64
+	df64,
+	dptr
 } data_type_T;
 
 // TOKEN TYPES
@@ -44,6 +45,9 @@ typedef enum {
 	tt_return,
 	tt_if,
 	tt_else,
+	tt_while,
+	tt_region,
+	tt_sizeof,
 
 	// data_type
 	tt_void,
@@ -88,6 +92,7 @@ typedef enum {
 	tt_gt,
 	tt_gte,
 	tt_at,
+	tt_dollar,
 
 	// misc tokens
 	tt_eof,
@@ -100,12 +105,29 @@ typedef enum {
 	ast_sub,
 	ast_mul,
 	ast_div,
+	ast_mod,
+	ast_lt,
+	ast_lte,
+	ast_gt,
+	ast_gte,
+	ast_eq,
+	ast_neq,
 	ast_const,
 	ast_ident,
 	ast_assign,
 	ast_function,
+	ast_call,
 	ast_return,
 	ast_at_asm,
+	ast_at_bench,
+	ast_if,
+	// `left ? mid : right`, made by inlining, parser does not produce it
+	ast_select,
+	ast_while,
+	ast_deref,
+	ast_store,
+	ast_alloca,
+	ast_region,
 	ast_join,
 	ast_noop
 } ast_type_T;
@@ -134,12 +156,26 @@ typedef enum {
 	CLOCAL
 } symbol_storage_class_T;
 
+typedef enum {
+	INLINE_AUTO,
+	INLINE_ALWAYS,
+	INLINE_NEVER
+} inline_hint_T;
+
 typedef struct SYMBOL_STRUCT {
 	symbol_structure_T symb_s;
 	symbol_storage_class_T symb_c;
 	const char *name;
 	data_type_T data_type;
 	uint64_t u64;
+	bool is_const;
+
+	// function parameters: register (int or sse) or stack position, -1 if none
+	bool is_param;
+	int8_t arg_reg;
+	int8_t arg_stack;
+
+	inline_hint_T inline_hint;
 } symbol_T;
 
 extern trie_node_T *token_trie_map;
@@ -148,6 +184,11 @@ extern uint64_t GLOBAL_INDEX;
 extern uint64_t LOCAL_INDEX;
 extern uint64_t SYMBOL_SIZE;
 extern symbol_T *SYMBOLS;
+// errors of program which compiler reported, compile with errors fails and its output is not cached
+extern uint64_t ERRORS;
+
+// prints error of program and counts it, modules are lexed by many threads at once.
+#define compile_error(...) ({ __atomic_add_fetch(&ERRORS, 1, __ATOMIC_RELAXED); printf(__VA_ARGS__); })
 
 // string formating
 #define formate_string(...) ({ __formate_string_function__(__VA_ARGS__, NULL); })
@@ -160,11 +201,23 @@ char *strjoin(const char *s0, const char *s1);
 char *strsub(const char *s, size_t fp, size_t tp);
 // string replace
 char *strreplace(char *s, unsigned char from, unsigned char to);
+
+// FNV-1a, data which is hashed in parts continues from hash of previous part
+#define HASH_SEED 14695981039346656037ULL
+uint64_t hash_bytes(const void *data, size_t length, uint64_t hash);
 size_t init_glob_symb(symbol_T symbol);
 size_t init_locl_symb(symbol_T symbol);
 const char *data_type_to_string(data_type_T data_type);
 data_type_T token_type_to_data_type(token_type_T token_type);
 uint8_t get_data_type_size(data_type_T data_type);
+bool is_signed_data_type(data_type_T data_type);
+bool is_float_data_type(data_type_T data_type);
+bool is_comparison(ast_type_T type);
+ast_type_T comparison_inverse(ast_type_T type);
+ast_type_T comparison_mirror(ast_type_T type);
+data_type_T builtin_data_type(const char *name);
+const char *builtin_symbol(const char *name);
+bool is_allocation(const char *name);
 data_type_T type_check(ast_type_T operation, data_type_T left, data_type_T right);
 
 #endif // __glob_h__
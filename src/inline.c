@@ -0,0 +1,225 @@
+#include "inline.h"
+#include "comptime.h"
+
+static uint64_t THRESHOLD = INLINE_THRESHOLD;
+
+static uint64_t count_uses(ast_T *root, size_t index)
+{
+	if (!root) return 0;
+
+	return
+		(root->type == ast_ident && root->index == index) +
+		count_uses(root->left, index) +
+		count_uses(root->mid, index) +
+		count_uses(root->right, index);
+}
+
+static ssize_t callee_of(ast_T *call)
+{
+	trie_value_T sv = trie_find(symbol_trie_map, call->token->value);
+	if (!sv.is_value || !FUNCTIONS[sv.value.i32]) return -1;
+
+	return sv.value.i32;
+}
+
+static ast_T *inline_value(ast_T *function, list_T *statements, size_t i);
+
+// value of block followed by statements from `next` on, where block falls through.
+static ast_T *inline_block(ast_T *function, ast_T *block, list_T *statements, size_t next)
+{
+	list_T *sequence = init_list(sizeof(ast_T *));
+	flatten_join(block, sequence);
+	for (size_t i = next; statements && i < list_length(statements); ++i)
+		list_push(sequence, list_get(statements, i));
+
+	ast_T *value = inline_value(function, sequence, 0);
+	list_free(sequence);
+
+	return value;
+}
+
+// value of statements from `i` on, every path through them has to end in return.
+// `if (c) return a; return b;` becomes `c ? a : b`.
+static ast_T *inline_value(ast_T *function, list_T *statements, size_t i)
+{
+	if (i >= list_length(statements)) return NULL;
+	ast_T *statement = list_get(statements, i);
+
+	if (statement->type == ast_return)
+	{
+		// wider value would have to be narrowed, which is done only by return.
+		ast_T *value = statement->left;
+		if (!value || get_data_type_size(value->data_type) > get_data_type_size(function->data_type)) return NULL;
+
+		return value;
+	}
+
+	if (statement->type != ast_if || !statement->left) return NULL;
+
+	ast_T *then = inline_block(function, statement->mid, statements, i + 1);
+	ast_T *otherwise = inline_block(function, statement->right, statements, i + 1);
+	if (!then || !otherwise) return NULL;
+
+	return init_ast(ast_select, function->data_type, statement->token, statement->left, then, otherwise, 0);
+}
+
+// only functions whose body is made of `if` and `return` can be put in place of call.
+static ast_T *inline_body(ast_T *function)
+{
+	if (!function->left) return NULL;
+
+	return inline_block(function, function->left, NULL, 0);
+}
+
+static bool calls_function(ast_T *root, size_t slot, bool *visited)
+{
+	if (!root) return false;
+
+	if (root->type == ast_call)
+	{
+		ssize_t callee = callee_of(root);
+		if (callee == (ssize_t)slot) return true;
+
+		if (callee >= 0 && !visited[callee])
+		{
+			visited[callee] = true;
+			if (calls_function(FUNCTIONS[callee]->left, slot, visited))
+				return true;
+		}
+	}
+
+	return
+		calls_function(root->left, slot, visited) ||
+		calls_function(root->mid, slot, visited) ||
+		calls_function(root->right, slot, visited);
+}
+
+static bool is_recursive(size_t slot)
+{
+	bool *visited = calloc(SYMBOL_SIZE, sizeof(bool));
+	bool recursive = calls_function(FUNCTIONS[slot]->left, slot, visited);
+	free(visited);
+
+	return recursive;
+}
+
+static bool should_inline(size_t slot)
+{
+	ast_T *function = FUNCTIONS[slot];
+	ast_T *body = inline_body(function);
+	inline_hint_T hint = SYMBOLS[slot].inline_hint;
+
+	if (hint == INLINE_NEVER || !body) return false;
+	if (is_recursive(slot)) return false;
+	if (hint == INLINE_ALWAYS) return true;
+
+	return ast_cost(body) <= THRESHOLD;
+}
+
+static ast_T *substitute(ast_T *root, list_T *params, list_T *args)
+{
+	if (!root) return NULL;
+
+	if (root->type == ast_ident)
+	{
+		for (size_t i = 0; i < list_length(params); ++i)
+		{
+			ast_T *param = list_get(params, i);
+			if (param->index != root->index) continue;
+
+			ast_T *arg = ast_clone(list_get(args, i));
+
+			// constants are converted to type of parameter.
+			if (arg->type == ast_const)
+			{
+				int64_t value = comptime_truncate(strtoll(arg->token->value, NULL, 10), param->data_type);
+				arg->token = init_token(tt_const_int, arg->token->position, formate_string("%ld", value));
+				arg->data_type = param->data_type;
+			}
+
+			return arg;
+		}
+	}
+
+	ast_T *ast = init_ast(root->type, root->data_type, root->token, NULL, NULL, NULL, root->index);
+	ast->left = substitute(root->left, params, args);
+	ast->mid = substitute(root->mid, params, args);
+	ast->right = substitute(root->right, params, args);
+
+	return ast;
+}
+
+static bool can_substitute(ast_T *function, list_T *params, list_T *args)
+{
+	ast_T *body = inline_body(function);
+	bool is_conditional = ast_contains(body, ast_select);
+
+	if (list_length(params) != list_length(args)) return false;
+	if (is_float_data_type(function->data_type)) return false;
+	if (get_data_type_size(body->data_type) > get_data_type_size(function->data_type)) return false;
+
+	size_t with_calls = 0;
+	for (size_t i = 0; i < list_length(params); ++i)
+	{
+		ast_T *param = list_get(params, i);
+		ast_T *arg = list_get(args, i);
+		uint64_t uses = count_uses(body, param->index);
+
+		// argument with side effect must be evaluated exactly once,
+		// non-trivial arguments are not computed twice.
+		if (ast_contains(arg, ast_call) && (uses != 1 || ++with_calls > 1)) return false;
+		// use in arm of select may not be evaluated at all.
+		if (ast_contains(arg, ast_call) && is_conditional) return false;
+		if (uses > 1 && ast_cost(arg) > 1) return false;
+
+		if (arg->type != ast_const && arg->data_type != param->data_type) return false;
+		if (arg->type == ast_const && arg->data_type == dstr) return false;
+	}
+
+	return true;
+}
+
+static ast_T *inline_calls(ast_T *root)
+{
+	if (!root) return NULL;
+
+	root->left = inline_calls(root->left);
+	root->mid = inline_calls(root->mid);
+	root->right = inline_calls(root->right);
+
+	if (root->type != ast_call) return root;
+
+	ssize_t slot = callee_of(root);
+	if (slot < 0 || !should_inline(slot)) return root;
+
+	ast_T *function = FUNCTIONS[slot];
+
+	list_T *params = init_list(sizeof(ast_T *));
+	list_T *args = init_list(sizeof(ast_T *));
+	flatten_join(function->mid, params);
+	flatten_join(root->left, args);
+
+	ast_T *ast = root;
+	if (can_substitute(function, params, args))
+	{
+		ast = substitute(inline_body(function), params, args);
+		if (ast->type == ast_const && ast->data_type == dnil)
+			ast->data_type = function->data_type;
+
+		// body can have calls which are worth inlining too.
+		ast = inline_calls(ast);
+	}
+
+	list_free(params);
+	list_free(args);
+
+	return ast;
+}
+
+ast_T *inline_functions(ast_T *root, uint64_t threshold)
+{
+	THRESHOLD = threshold;
+
+	root = inline_calls(root);
+	return comptime_fold_constants(root);
+}
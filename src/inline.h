@@ -0,0 +1,14 @@
+#ifndef __inline_h__
+#define __inline_h__
+
+#include "glob.h"
+#include "parser.h"
+
+// max cost (number of nodes) of function body that is inlined, body is either
+// `return expr;` or chain of `if (c) return a;` which is inlined as `c ? a : b`.
+#define INLINE_THRESHOLD 16
+
+// inline small non-recursive functions, then fold constants
+ast_T *inline_functions(ast_T *root, uint64_t threshold);
+
+#endif // __inline_h__
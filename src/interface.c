@@ -0,0 +1,434 @@
+#include "interface.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// growing bytes of one section of file
+typedef struct {
+	char *data;
+	size_t length;
+	size_t capacity;
+} buffer_T;
+
+static size_t buffer_append(buffer_T *buffer, const void *data, size_t length)
+{
+	if (buffer->length + length > buffer->capacity)
+	{
+		while (buffer->length + length > buffer->capacity)
+			buffer->capacity = buffer->capacity ? buffer->capacity * 2 : 256;
+		buffer->data = realloc(buffer->data, buffer->capacity);
+	}
+
+	memcpy(buffer->data + buffer->length, data, length);
+	buffer->length += length;
+
+	return buffer->length - length;
+}
+
+// open addressing map from key to record, keys are pointers or hashes of strings.
+typedef struct {
+	uint64_t *keys;
+	uint32_t *values;
+	size_t capacity;
+	size_t length;
+} record_map_T;
+
+static void record_map_grow(record_map_T *map)
+{
+	record_map_T old = *map;
+
+	map->capacity = old.capacity ? old.capacity * 2 : 64;
+	map->keys = calloc(map->capacity, sizeof(uint64_t));
+	map->values = malloc(map->capacity * sizeof(uint32_t));
+	map->length = 0;
+
+	for (size_t i = 0; i < old.capacity; ++i)
+	{
+		if (!old.keys[i]) continue;
+
+		size_t at = old.keys[i] & (map->capacity - 1);
+		while (map->keys[at]) at = (at + 1) & (map->capacity - 1);
+		map->keys[at] = old.keys[i];
+		map->values[at] = old.values[i];
+		map->length++;
+	}
+
+	free(old.keys);
+	free(old.values);
+}
+
+// slot of key, keys are never zero. `same` tells whether record of equal key is the one searched for.
+static size_t record_map_slot(record_map_T *map, uint64_t key, bool (*same)(uint32_t, const void *), const void *arg)
+{
+	if (2 * (map->length + 1) > map->capacity) record_map_grow(map);
+
+	size_t at = key & (map->capacity - 1);
+	while (map->keys[at] && (map->keys[at] != key || (same && !same(map->values[at], arg))))
+		at = (at + 1) & (map->capacity - 1);
+
+	return at;
+}
+
+static void record_map_free(record_map_T *map)
+{
+	free(map->keys);
+	free(map->values);
+}
+
+typedef struct {
+	buffer_T symbols, nodes, tokens, externs, strings;
+	record_map_T string_map, node_map, token_map, extern_map;
+	size_t first_global, first_local;
+	uint32_t node_count, token_count, extern_count;
+} writer_T;
+
+static writer_T *WRITER;
+
+static bool same_string(uint32_t offset, const void *string)
+{
+	return !strcmp(WRITER->strings.data + offset, string);
+}
+
+static uint32_t write_string(writer_T *writer, const char *string)
+{
+	if (!string) return INTERFACE_NONE;
+
+	uint64_t key = hash_bytes(string, strlen(string), HASH_SEED) | 1;
+	size_t at = record_map_slot(&writer->string_map, key, same_string, string);
+	if (writer->string_map.keys[at]) return writer->string_map.values[at];
+
+	uint32_t offset = buffer_append(&writer->strings, string, strlen(string) + 1);
+	writer->string_map.keys[at] = key;
+	writer->string_map.values[at] = offset;
+	writer->string_map.length++;
+
+	return offset;
+}
+
+static void write_symbol(writer_T *writer, size_t slot)
+{
+	symbol_T *symbol = &SYMBOLS[slot];
+	interface_symbol_T record = {
+		.name = write_string(writer, symbol->name),
+		.symb_s = symbol->symb_s,
+		.data_type = symbol->data_type,
+		.is_const = symbol->is_const,
+		.is_param = symbol->is_param,
+		.arg_reg = symbol->arg_reg,
+		.arg_stack = symbol->arg_stack,
+		.inline_hint = symbol->inline_hint,
+		.u64 = symbol->u64
+	};
+
+	buffer_append(&writer->symbols, &record, sizeof(record));
+}
+
+// tokens are shared between nodes (and changed through them later), so each is stored once.
+static uint32_t write_token(writer_T *writer, token_T *token)
+{
+	if (!token) return INTERFACE_NONE;
+
+	size_t at = record_map_slot(&writer->token_map, (uintptr_t)token, NULL, NULL);
+	if (writer->token_map.keys[at]) return writer->token_map.values[at];
+
+	interface_token_T record = {
+		.type = token->type,
+		.value = write_string(writer, token->value),
+		.ln = token->position.ln,
+		.clm = token->position.clm,
+		.len = token->position.len
+	};
+	buffer_append(&writer->tokens, &record, sizeof(record));
+
+	writer->token_map.keys[at] = (uintptr_t)token;
+	writer->token_map.values[at] = writer->token_count;
+	writer->token_map.length++;
+
+	return writer->token_count++;
+}
+
+static uint32_t write_extern(writer_T *writer, size_t slot)
+{
+	size_t at = record_map_slot(&writer->extern_map, slot + 1, NULL, NULL);
+	if (writer->extern_map.keys[at]) return writer->extern_map.values[at];
+
+	uint32_t name = write_string(writer, SYMBOLS[slot].name);
+	buffer_append(&writer->externs, &name, sizeof(name));
+
+	writer->extern_map.keys[at] = slot + 1;
+	writer->extern_map.values[at] = writer->extern_count;
+	writer->extern_map.length++;
+
+	return writer->extern_count++;
+}
+
+// children are written before their parent, so loader can link them in one pass.
+static uint32_t write_node(writer_T *writer, ast_T *root)
+{
+	if (!root) return INTERFACE_NONE;
+
+	size_t at = record_map_slot(&writer->node_map, (uintptr_t)root, NULL, NULL);
+	if (writer->node_map.keys[at]) return writer->node_map.values[at];
+
+	interface_node_T record = {
+		.type = root->type,
+		.data_type = root->data_type,
+		.reference = IREF_NONE,
+		.token = write_token(writer, root->token),
+		.left = write_node(writer, root->left),
+		.mid = write_node(writer, root->mid),
+		.right = write_node(writer, root->right),
+		.index = root->index
+	};
+
+	// only these nodes hold slot of symbol in index.
+	if (root->type == ast_ident || root->type == ast_assign || root->type == ast_function)
+	{
+		if (root->index >= writer->first_global && root->index < GLOBAL_INDEX)
+		{
+			record.reference = IREF_GLOBAL;
+			record.index = root->index - writer->first_global;
+		}
+		else if (root->index <= writer->first_local && root->index > LOCAL_INDEX)
+		{
+			record.reference = IREF_LOCAL;
+			record.index = writer->first_local - root->index;
+		}
+		else
+		{
+			record.reference = IREF_EXTERN;
+			record.index = write_extern(writer, root->index);
+		}
+	}
+
+	buffer_append(&writer->nodes, &record, sizeof(record));
+
+	// children might have been added to map meanwhile, so slot is searched again.
+	at = record_map_slot(&writer->node_map, (uintptr_t)root, NULL, NULL);
+	writer->node_map.keys[at] = (uintptr_t)root;
+	writer->node_map.values[at] = writer->node_count;
+	writer->node_map.length++;
+
+	return writer->node_count++;
+}
+
+bool interface_write(
+	const char *path, uint64_t source_hash, uint64_t hash, list_T *imports,
+	ast_T *root, size_t first_global, size_t first_local
+)
+{
+	writer_T writer = { .first_global = first_global, .first_local = first_local };
+	WRITER = &writer;
+
+	for (size_t slot = first_global; slot < GLOBAL_INDEX; ++slot)
+		write_symbol(&writer, slot);
+	for (size_t slot = first_local; slot > LOCAL_INDEX; --slot)
+		write_symbol(&writer, slot);
+
+	interface_header_T header = {
+		.magic = INTERFACE_MAGIC,
+		.version = INTERFACE_VERSION,
+		.source_hash = source_hash,
+		.hash = hash,
+		.globals = GLOBAL_INDEX - first_global,
+		.locals = first_local - LOCAL_INDEX,
+		.root = write_node(&writer, root),
+		.imports = list_length(imports)
+	};
+
+	uint32_t *import_names = malloc((header.imports + 1) * sizeof(uint32_t));
+	for (size_t i = 0; i < header.imports; ++i)
+		import_names[i] = write_string(&writer, list_get(imports, i));
+
+	header.nodes = writer.node_count;
+	header.tokens = writer.token_count;
+	header.externs = writer.extern_count;
+	header.strings_size = writer.strings.length;
+
+	char *temporary = formate_string("%s.%d.tmp", path, getpid());
+	FILE *file = fopen(temporary, "wb");
+	bool success = file != NULL;
+
+	if (file)
+	{
+		fwrite(&header, sizeof(header), 1, file);
+		fwrite(writer.symbols.data, 1, writer.symbols.length, file);
+		fwrite(writer.nodes.data, 1, writer.nodes.length, file);
+		fwrite(writer.tokens.data, 1, writer.tokens.length, file);
+		fwrite(import_names, sizeof(uint32_t), header.imports, file);
+		fwrite(writer.externs.data, 1, writer.externs.length, file);
+		fwrite(writer.strings.data, 1, writer.strings.length, file);
+
+		success = !ferror(file);
+		success &= !fclose(file);
+		success = success && !rename(temporary, path);
+		if (!success) unlink(temporary);
+	}
+
+	free(temporary);
+	free(import_names);
+	free(writer.symbols.data);
+	free(writer.nodes.data);
+	free(writer.tokens.data);
+	free(writer.externs.data);
+	free(writer.strings.data);
+	record_map_free(&writer.string_map);
+	record_map_free(&writer.node_map);
+	record_map_free(&writer.token_map);
+	record_map_free(&writer.extern_map);
+	WRITER = NULL;
+
+	return success;
+}
+
+interface_T *interface_open(const char *path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return NULL;
+
+	struct stat st;
+	if (fstat(fd, &st) || (size_t)st.st_size < sizeof(interface_header_T))
+	{
+		close(fd);
+		return NULL;
+	}
+
+	// private mapping, later passes may change strings of tokens in place.
+	void *data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) return NULL;
+
+	const interface_header_T *header = data;
+	size_t size =
+		sizeof(interface_header_T) +
+		(size_t)(header->globals + header->locals) * sizeof(interface_symbol_T) +
+		(size_t)header->nodes * sizeof(interface_node_T) +
+		(size_t)header->tokens * sizeof(interface_token_T) +
+		(size_t)(header->imports + header->externs) * sizeof(uint32_t) +
+		header->strings_size;
+
+	if (header->magic != INTERFACE_MAGIC || header->version != INTERFACE_VERSION || size != (size_t)st.st_size)
+	{
+		munmap(data, st.st_size);
+		return NULL;
+	}
+
+	interface_T *interface = malloc(sizeof(interface_T));
+	interface->data = data;
+	interface->size = st.st_size;
+	interface->header = header;
+	interface->symbols = (const interface_symbol_T *)(header + 1);
+	interface->nodes = (const interface_node_T *)(interface->symbols + header->globals + header->locals);
+	interface->tokens = (const interface_token_T *)(interface->nodes + header->nodes);
+	interface->imports = (const uint32_t *)(interface->tokens + header->tokens);
+	interface->externs = interface->imports + header->imports;
+	interface->strings = (char *)(interface->externs + header->externs);
+
+	return interface;
+}
+
+void interface_close(interface_T *interface)
+{
+	munmap(interface->data, interface->size);
+	free(interface);
+}
+
+const char *interface_import(interface_T *interface, size_t i)
+{
+	return interface->strings + interface->imports[i];
+}
+
+static symbol_T load_symbol(interface_T *interface, size_t i, symbol_storage_class_T symb_c)
+{
+	const interface_symbol_T *record = &interface->symbols[i];
+
+	return (symbol_T){
+		.symb_s = record->symb_s,
+		.symb_c = symb_c,
+		.name = interface->strings + record->name,
+		.data_type = record->data_type,
+		.u64 = record->u64,
+		.is_const = record->is_const,
+		.is_param = record->is_param,
+		.arg_reg = record->arg_reg,
+		.arg_stack = record->arg_stack,
+		.inline_hint = record->inline_hint
+	};
+}
+
+bool interface_load(interface_T *interface, ast_T **root)
+{
+	const interface_header_T *header = interface->header;
+
+	// everything is checked before first symbol is defined.
+	size_t *externs = malloc((header->externs + 1) * sizeof(size_t));
+	for (size_t i = 0; i < header->externs; ++i)
+	{
+		trie_value_T sv = trie_find(symbol_trie_map, interface->strings + interface->externs[i]);
+		if (!sv.is_value)
+		{
+			free(externs);
+			return false;
+		}
+		externs[i] = sv.value.i32;
+	}
+
+	for (size_t i = 0; i < header->globals; ++i)
+	{
+		const char *name = interface->strings + interface->symbols[i].name;
+		if (!trie_find(symbol_trie_map, name).is_value) continue;
+
+		compile_error("err :: `%s` already defined.\n", name);
+		free(externs);
+		return false;
+	}
+
+	size_t first_global = GLOBAL_INDEX, first_local = LOCAL_INDEX;
+	for (size_t i = 0; i < header->globals; ++i)
+	{
+		size_t slot = init_glob_symb(load_symbol(interface, i, CGLOBAL));
+		trie_insert(symbol_trie_map, SYMBOLS[slot].name, (trie_value_T){ .value.i32 = slot });
+	}
+	for (size_t i = 0; i < header->locals; ++i)
+		init_locl_symb(load_symbol(interface, header->globals + i, CLOCAL));
+
+	token_T *tokens = malloc((header->tokens + 1) * sizeof(token_T));
+	for (size_t i = 0; i < header->tokens; ++i)
+	{
+		const interface_token_T *record = &interface->tokens[i];
+		tokens[i] = (token_T){
+			.type = record->type,
+			.position = { .ln = record->ln, .clm = record->clm, .len = record->len },
+			.value = record->value == INTERFACE_NONE ? NULL : interface->strings + record->value
+		};
+	}
+
+	ast_T *nodes = malloc((header->nodes + 1) * sizeof(ast_T));
+	for (size_t i = 0; i < header->nodes; ++i)
+	{
+		const interface_node_T *record = &interface->nodes[i];
+		ast_T *node = &nodes[i];
+
+		node->type = record->type;
+		node->data_type = record->data_type;
+		node->token = record->token == INTERFACE_NONE ? NULL : &tokens[record->token];
+		node->left = record->left == INTERFACE_NONE ? NULL : &nodes[record->left];
+		node->mid = record->mid == INTERFACE_NONE ? NULL : &nodes[record->mid];
+		node->right = record->right == INTERFACE_NONE ? NULL : &nodes[record->right];
+
+		switch (record->reference)
+		{
+			case IREF_GLOBAL: node->index = first_global + record->index; break;
+			case IREF_LOCAL: node->index = first_local - record->index; break;
+			case IREF_EXTERN: node->index = externs[record->index]; break;
+			default: node->index = record->index;
+		}
+
+		if (node->type == ast_function) FUNCTIONS[node->index] = node;
+	}
+	free(externs);
+
+	*root = header->root == INTERFACE_NONE ? NULL : &nodes[header->root];
+	return true;
+}
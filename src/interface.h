@@ -0,0 +1,118 @@
+#ifndef __interface_h__
+#define __interface_h__
+
+#include "glob.h"
+#include "list.h"
+#include "parser.h"
+
+// interface of imported module is written next to it, `std.tl` -> `std.tli`
+#define INTERFACE_EXTENSION "i"
+
+#define INTERFACE_MAGIC 0x494c5424 // "$TLI"
+// bumped whenever layout of records or meaning of ast changes.
+// 2: interfaces are only written for modules without errors, those of 1 may come from broken parse
+// 3: ast_select was added to ast types
+#define INTERFACE_VERSION 3
+
+// reference of record which is not there (child, token, token value)
+#define INTERFACE_NONE UINT32_MAX
+
+// file is header followed by symbols, nodes, tokens, imports, externs and strings.
+// strings are zero terminated and referenced by offset, every string is stored once.
+typedef struct {
+	uint32_t magic;
+	uint32_t version;
+	// hash of source, interface of file which has changed is not opened
+	uint64_t source_hash;
+	// hash of source and hashes of imported modules, see load_modules
+	uint64_t hash;
+	uint32_t globals;
+	uint32_t locals;
+	uint32_t nodes;
+	uint32_t tokens;
+	uint32_t imports;
+	uint32_t externs;
+	uint32_t root;
+	uint32_t strings_size;
+} interface_header_T;
+
+// symbol which module defines, globals are exported
+typedef struct {
+	uint32_t name;
+	uint8_t symb_s;
+	uint8_t data_type;
+	uint8_t is_const;
+	uint8_t is_param;
+	int8_t arg_reg;
+	int8_t arg_stack;
+	uint8_t inline_hint;
+	uint8_t pad;
+	uint64_t u64;
+} interface_symbol_T;
+
+typedef struct {
+	uint32_t type;
+	uint32_t value;
+	uint32_t ln;
+	uint32_t clm;
+	uint8_t len;
+	uint8_t pad[7];
+} interface_token_T;
+
+// how index of node is stored
+typedef enum {
+	IREF_NONE,
+	// global of module, index is its position among globals
+	IREF_GLOBAL,
+	// local of module, index is its position among locals
+	IREF_LOCAL,
+	// global of imported module, index is position of its name among externs
+	IREF_EXTERN
+} interface_reference_T;
+
+typedef struct {
+	uint8_t type;
+	uint8_t data_type;
+	uint8_t reference;
+	uint8_t pad;
+	uint32_t token;
+	uint32_t left;
+	uint32_t mid;
+	uint32_t right;
+	uint32_t pad2;
+	uint64_t index;
+} interface_node_T;
+
+// interface mapped into memory, records are used in place.
+typedef struct {
+	void *data;
+	size_t size;
+	const interface_header_T *header;
+	const interface_symbol_T *symbols;
+	const interface_node_T *nodes;
+	const interface_token_T *tokens;
+	const uint32_t *imports;
+	const uint32_t *externs;
+	char *strings;
+} interface_T;
+
+// NULL if there is no interface at path or it was written by another version.
+interface_T *interface_open(const char *path);
+void interface_close(interface_T *interface);
+
+// name of i-th module which is imported, as written after `import`.
+const char *interface_import(interface_T *interface, size_t i);
+
+// defines symbols of module and rebuilds its tree, as parser would.
+// false (and nothing is defined) if extern symbol is missing or global is already defined.
+bool interface_load(interface_T *interface, ast_T **root);
+
+// writes tree of module which was just parsed. its globals are slots from `first_global`
+// to GLOBAL_INDEX, its locals from `first_local` down to LOCAL_INDEX.
+// file is written under temporary name and renamed, so readers never see part of it.
+bool interface_write(
+	const char *path, uint64_t source_hash, uint64_t hash, list_T *imports,
+	ast_T *root, size_t first_global, size_t first_local
+);
+
+#endif // __interface_h__
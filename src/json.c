@@ -0,0 +1,323 @@
+#include "json.h"
+
+typedef struct {
+	const char *at;
+	const char *end;
+	int depth;
+} json_reader_T;
+
+static json_T *json_value(json_reader_T *reader);
+
+static void json_skip(json_reader_T *reader)
+{
+	while (reader->at < reader->end && isspace((unsigned char)*reader->at)) reader->at++;
+}
+
+static bool json_literal(json_reader_T *reader, const char *literal)
+{
+	size_t length = strlen(literal);
+	if ((size_t)(reader->end - reader->at) < length || strncmp(reader->at, literal, length))
+		return false;
+
+	reader->at += length;
+	return true;
+}
+
+static int json_hex(json_reader_T *reader)
+{
+	if (reader->end - reader->at < 4) return -1;
+
+	int value = 0;
+	for (int i = 0; i < 4; ++i)
+	{
+		char c = *reader->at++;
+		value <<= 4;
+		if (c >= '0' && c <= '9') value |= c - '0';
+		else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+		else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+		else return -1;
+	}
+
+	return value;
+}
+
+static size_t json_utf8(char *out, uint32_t code)
+{
+	if (code < 0x80) return out[0] = code, 1;
+	if (code < 0x800) return out[0] = 0xc0 | code >> 6, out[1] = 0x80 | (code & 0x3f), 2;
+	if (code < 0x10000)
+		return out[0] = 0xe0 | code >> 12, out[1] = 0x80 | (code >> 6 & 0x3f), out[2] = 0x80 | (code & 0x3f), 3;
+
+	out[0] = 0xf0 | code >> 18;
+	out[1] = 0x80 | (code >> 12 & 0x3f);
+	out[2] = 0x80 | (code >> 6 & 0x3f);
+	out[3] = 0x80 | (code & 0x3f);
+	return 4;
+}
+
+// escaped text is never shorter than what it stands for.
+static char *json_string(json_reader_T *reader)
+{
+	if (reader->at >= reader->end || *reader->at != '"') return NULL;
+	reader->at++;
+
+	char *string = malloc(reader->end - reader->at + 1);
+	size_t length = 0;
+
+	while (reader->at < reader->end && *reader->at != '"')
+	{
+		char c = *reader->at++;
+		if (c != '\\')
+		{
+			string[length++] = c;
+			continue;
+		}
+
+		if (reader->at >= reader->end) break;
+		switch (c = *reader->at++)
+		{
+			case 'n': string[length++] = '\n'; break;
+			case 't': string[length++] = '\t'; break;
+			case 'r': string[length++] = '\r'; break;
+			case 'b': string[length++] = '\b'; break;
+			case 'f': string[length++] = '\f'; break;
+			case 'u':
+			{
+				int code = json_hex(reader);
+				if (code < 0) break;
+
+				// surrogate pair is one character.
+				if (code >= 0xd800 && code < 0xdc00 && json_literal(reader, "\\u"))
+				{
+					int low = json_hex(reader);
+					if (low >= 0xdc00 && low < 0xe000) code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+				}
+				length += json_utf8(string + length, code);
+			} break;
+			default: string[length++] = c;
+		}
+	}
+
+	if (reader->at >= reader->end)
+	{
+		free(string);
+		return NULL;
+	}
+
+	reader->at++;
+	string[length] = '\0';
+
+	return string;
+}
+
+static json_T *json_items(json_reader_T *reader, json_T *json, char close)
+{
+	reader->at++;
+	json_skip(reader);
+	if (reader->at < reader->end && *reader->at == close)
+	{
+		reader->at++;
+		return json;
+	}
+
+	while (reader->at < reader->end)
+	{
+		json_T *item;
+		if (json->type == JSON_OBJECT)
+		{
+			char *key = json_string(reader);
+			json_skip(reader);
+			if (!key || reader->at >= reader->end || *reader->at++ != ':')
+			{
+				free(key);
+				return NULL;
+			}
+
+			json_T *value = json_value(reader);
+			if (!value)
+			{
+				free(key);
+				return NULL;
+			}
+
+			item = calloc(1, sizeof(json_T));
+			item->string = key;
+			item->value = value;
+		}
+		else if (!(item = json_value(reader))) return NULL;
+
+		list_push(json->items, item);
+		json_skip(reader);
+
+		if (reader->at >= reader->end) return NULL;
+		char c = *reader->at++;
+		if (c == close) return json;
+		if (c != ',') return NULL;
+		json_skip(reader);
+	}
+
+	return NULL;
+}
+
+static json_T *json_value(json_reader_T *reader)
+{
+	json_skip(reader);
+	if (reader->at >= reader->end) return NULL;
+
+	json_T *json = calloc(1, sizeof(json_T));
+	char c = *reader->at;
+
+	if (c == '{' || c == '[')
+	{
+		json->type = c == '{' ? JSON_OBJECT : JSON_ARRAY;
+		json->items = init_list(sizeof(json_T *));
+
+		reader->depth++;
+		bool valid = reader->depth <= JSON_MAX_DEPTH && json_items(reader, json, c == '{' ? '}' : ']');
+		reader->depth--;
+
+		if (valid) return json;
+	}
+	else if (c == '"')
+	{
+		json->type = JSON_STRING;
+		if ((json->string = json_string(reader))) return json;
+	}
+	else if (json_literal(reader, "null")) return json;
+	else if (json_literal(reader, "true") || json_literal(reader, "false"))
+	{
+		json->type = JSON_BOOL;
+		json->boolean = reader->at[-1] == 'e' && reader->at[-4] == 't';
+		return json;
+	}
+	else
+	{
+		// number is not terminated, so it is copied before it is read.
+		const char *start = reader->at;
+		while (reader->at < reader->end && *reader->at && strchr("+-0123456789.eE", *reader->at)) reader->at++;
+
+		if (reader->at > start)
+		{
+			char *number = strsub(start, 0, reader->at - start);
+			char *end;
+			json->type = JSON_NUMBER;
+			json->number = strtod(number, &end);
+
+			bool valid = !*end;
+			free(number);
+			if (valid) return json;
+		}
+	}
+
+	json_free(json);
+	return NULL;
+}
+
+json_T *json_parse(const char *text, size_t length)
+{
+	json_reader_T reader = { .at = text, .end = text + length, .depth = 0 };
+	json_T *json = json_value(&reader);
+
+	json_skip(&reader);
+	if (json && reader.at != reader.end)
+	{
+		json_free(json);
+		return NULL;
+	}
+
+	return json;
+}
+
+void json_free(json_T *json)
+{
+	if (!json) return;
+
+	if (json->items)
+	{
+		for (size_t i = 0; i < list_length(json->items); ++i)
+			json_free(list_get(json->items, i));
+		list_free(json->items);
+	}
+
+	json_free(json->value);
+	free(json->string);
+	free(json);
+}
+
+json_T *json_get(json_T *object, const char *key)
+{
+	if (!object || object->type != JSON_OBJECT) return NULL;
+
+	for (size_t i = 0; i < list_length(object->items); ++i)
+	{
+		json_T *member = list_get(object->items, i);
+		if (!strcmp(member->string, key)) return member->value;
+	}
+
+	return NULL;
+}
+
+const char *json_get_string(json_T *object, const char *key, const char *fallback)
+{
+	json_T *value = json_get(object, key);
+
+	return value && value->type == JSON_STRING ? value->string : fallback;
+}
+
+double json_get_number(json_T *object, const char *key, double fallback)
+{
+	json_T *value = json_get(object, key);
+
+	return value && value->type == JSON_NUMBER ? value->number : fallback;
+}
+
+char *json_write(json_T *json)
+{
+	if (!json) return strdup("null");
+
+	switch (json->type)
+	{
+		case JSON_BOOL: return strdup(json->boolean ? "true" : "false");
+		case JSON_NUMBER: return formate_string("%.17g", json->number);
+		case JSON_STRING: return json_quote(json->string);
+		case JSON_ARRAY:
+		case JSON_OBJECT:
+		{
+			char *text = strdup(json->type == JSON_ARRAY ? "[" : "{");
+			for (size_t i = 0; i < list_length(json->items); ++i)
+			{
+				json_T *item = list_get(json->items, i);
+				if (i) text = strjoin(text, ",");
+				if (json->type == JSON_OBJECT)
+				{
+					text = strjoin(text, json_quote(item->string));
+					text = strjoin(text, ":");
+					item = item->value;
+				}
+				text = strjoin(text, json_write(item));
+			}
+			return strjoin(text, json->type == JSON_ARRAY ? "]" : "}");
+		}
+		default: return strdup("null");
+	}
+}
+
+char *json_quote(const char *string)
+{
+	size_t length = 2;
+	for (const char *at = string; *at; ++at) length += (unsigned char)*at < 0x20 ? 6 : strchr("\"\\", *at) ? 2 : 1;
+
+	char *quoted = malloc(length + 1), *out = quoted;
+	*out++ = '"';
+	for (const char *at = string; *at; ++at)
+	{
+		unsigned char c = *at;
+		if (c == '"' || c == '\\') *out++ = '\\', *out++ = c;
+		else if (c < 0x20) out += sprintf(out, "\\u%04x", c);
+		else *out++ = c;
+	}
+	*out++ = '"';
+	*out = '\0';
+
+	return quoted;
+}
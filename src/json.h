@@ -0,0 +1,49 @@
+#ifndef __json_h__
+#define __json_h__
+
+#include "glob.h"
+#include "list.h"
+
+// max depth of nested arrays and objects, deeper text is rejected
+#define JSON_MAX_DEPTH 64
+
+typedef enum {
+	JSON_NULL,
+	JSON_BOOL,
+	JSON_NUMBER,
+	JSON_STRING,
+	JSON_ARRAY,
+	JSON_OBJECT
+} json_type_T;
+
+typedef struct JSON_STRUCT json_T;
+
+typedef struct JSON_STRUCT {
+	json_type_T type;
+	bool boolean;
+	double number;
+	// string, or key of member of object
+	char *string;
+	// items of array, members of object (members hold their key in `string` and value in `value`)
+	list_T *items;
+	json_T *value;
+} json_T;
+
+// value of text, NULL if text is not valid json.
+json_T *json_parse(const char *text, size_t length);
+void json_free(json_T *json);
+
+// member of object, NULL if it is missing or json is not an object.
+json_T *json_get(json_T *object, const char *key);
+
+// values of members, `fallback` if they are missing or of other type.
+const char *json_get_string(json_T *object, const char *key, const char *fallback);
+double json_get_number(json_T *object, const char *key, double fallback);
+
+// value written back as json text, for ids of requests which are echoed.
+char *json_write(json_T *json);
+
+// string as quoted and escaped json string.
+char *json_quote(const char *string);
+
+#endif // __json_h__
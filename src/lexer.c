@@ -26,6 +26,9 @@ const char *token_type_to_string(token_type_T type)
 		case tt_return: token2string = "tt_return"; break;
 		case tt_if: token2string = "tt_if"; break;
 		case tt_else: token2string = "tt_else"; break;
+		case tt_while: token2string = "tt_while"; break;
+		case tt_region: token2string = "tt_region"; break;
+		case tt_sizeof: token2string = "tt_sizeof"; break;
 		case tt_plus: token2string = "tt_plus"; break;
 		case tt_void: token2string = "tt_void"; break;
 		case tt_char: token2string = "tt_char"; break;
@@ -66,6 +69,7 @@ const char *token_type_to_string(token_type_T type)
 		case tt_gt: token2string = "tt_gt"; break;
 		case tt_gte: token2string = "tt_gte"; break;
 		case tt_at: token2string = "tt_at"; break;
+		case tt_dollar: token2string = "tt_dollar"; break;
 		case tt_eof: token2string = "tt_eof"; break;
 		case tt_unknown_token: token2string = "tt_unknown_token"; break;
 	}
@@ -75,15 +79,25 @@ const char *token_type_to_string(token_type_T type)
 
 // create lexer 
 lexer_T *init_lexer(const char *filename)
+{
+	report_begin("read_file");
+	char *content = read_file(filename);
+	report_end();
+	report_count("source_bytes", strlen(content));
+
+	return init_lexer_from_text(filename, content, (position_T){ .ln = 1, .clm = 1, .len = 0 });
+}
+
+lexer_T *init_lexer_from_text(const char *filename, char *content, position_T position)
 {
 	lexer_T *lexer = malloc(sizeof(lexer_T));
-	lexer->filename = malloc(strlen(filename) + 1);
 	lexer->filename = strdup(filename);
-	lexer->content = read_file(filename);
+	lexer->content = content;
 	lexer->content_length = strlen(lexer->content) + 1;
 	lexer->index = 0;
 	lexer->current_char = lexer->content[lexer->index];
-	lexer->position = (position_T){ .ln = 1, .clm = 1, .len = 0 };
+	lexer->position = position;
+	lexer->unclosed = false;
 	return lexer;
 }
 
@@ -141,10 +155,7 @@ token_T *lexer_do_digit(lexer_T *lexer)
 	buffer[index] = '\0';
 
 	if (dots > 1)
-	{
-		printf("err :: more than one `.` found in number literal.\n");
-		return NULL;
-	}
+		compile_error("err :: more than one `.` found in number literal.\n");
 
 	return init_token(
 		dots ? tt_const_float : tt_const_int,
@@ -230,8 +241,6 @@ token_T *lexer_lex_tchar(lexer_T *lexer, unsigned char nc, token_type_T tt_a, to
 
 token_T *lexer_lex_string(lexer_T *lexer)
 {
-	// TODO: implement espace seq thingy
-	
 	position_T position = lexer->position;
 
 	lexer_advance(lexer);
@@ -239,27 +248,55 @@ token_T *lexer_lex_string(lexer_T *lexer)
 	lexer_T *tmp = malloc(sizeof(lexer_T));
 	memcpy(tmp, lexer, sizeof(lexer_T));
 
+	// escape sequence is never longer than its source.
 	size_t word_size = 0;
-	while (tmp->current_char != '"')
+	while (tmp->current_char != '"' && tmp->current_char != '\0')
 	{
+		if (tmp->current_char == '\\') lexer_advance(tmp);
 		word_size++;
 		lexer_advance(tmp);
 	}
-
-	// TODO: no need for tmp
+	free(tmp);
 
 	char *buffer = malloc(word_size + 1);
 	size_t idx = 0;
 
-	while (lexer->current_char != '"')
+	while (lexer->current_char != '"' && lexer->current_char != '\0')
 	{
-		buffer[idx++] = lexer->current_char;
+		char c = lexer->current_char;
+		if (c == '\\')
+		{
+			lexer_advance(lexer);
+			switch (lexer->current_char)
+			{
+				case 'n': c = '\n'; break;
+				case 't': c = '\t'; break;
+				case 'r': c = '\r'; break;
+				case '\\': c = '\\'; break;
+				case '"': c = '"'; break;
+				default:
+				{
+					compile_error("err :: unknown escape sequence `\\%c` at %ld:%ld.\n",
+						lexer->current_char, lexer->position.ln, lexer->position.clm);
+					c = lexer->current_char;
+				}
+			}
+		}
+
+		buffer[idx++] = c;
 		lexer_advance(lexer);
 	}
 
 	buffer[idx] = '\0';
 
-	lexer_advance(lexer);
+	// string which is not closed ends with text.
+	if (lexer->current_char == '"')
+		lexer_advance(lexer);
+	else
+	{
+		compile_error("err :: string is not closed.\n");
+		lexer->unclosed = true;
+	}
 
 	token_T *token = init_token(
 			tt_string,
@@ -280,6 +317,7 @@ list_T *lexer_get_tokens(lexer_T *lexer)
 	{
 		// check for any whitespaces
 		lexer_skip_whitespaces(lexer);
+		if (!lexer->current_char) break;
 
 		// check if it needs to be lexed as whole, if not
 		if (isdigit(lexer->current_char))
@@ -308,6 +346,7 @@ list_T *lexer_get_tokens(lexer_T *lexer)
 				case ')': list_push(tokens, lexer_lex_char(lexer, tt_rparan)); break;
 				case '.': list_push(tokens, lexer_lex_char(lexer, tt_dot)); break;
 				case '@': list_push(tokens, lexer_lex_char(lexer, tt_at)); break;
+				case '$': list_push(tokens, lexer_lex_char(lexer, tt_dollar)); break;
 				case '-': list_push(tokens, lexer_lex_tchar(lexer, '>', tt_minus, tt_right_arrow)); break;
 				case ':': list_push(tokens, lexer_lex_tchar(lexer, ':', tt_colon, tt_dcolon)); break;
 				case '=': list_push(tokens, lexer_lex_tchar(lexer, '=', tt_assign, tt_eq)); break;
@@ -321,7 +360,7 @@ list_T *lexer_get_tokens(lexer_T *lexer)
 					list_push(tokens, token);
 
 					// TODO: proper error management
-					printf(
+					compile_error(
 							"err :: unknown token `%s` (%ld:%ld).\n",
 							token->value, token->position.ln, token->position.clm
 					);
@@ -4,6 +4,7 @@
 #include "glob.h"
 #include "list.h"
 #include "io.h"
+#include "report.h"
 
 typedef struct
 {
@@ -14,6 +15,8 @@ typedef struct
 	uint64_t current_line;
 	size_t content_length;
 	position_T position;
+	// string was not closed before end of text
+	bool unclosed;
 } lexer_T;
 
 // create token
@@ -25,6 +28,9 @@ const char *token_type_to_string(token_type_T type);
 // create lexer 
 lexer_T *init_lexer(const char *filename);
 
+// lexer of text which is already in memory, positions of its tokens start at `position`
+lexer_T *init_lexer_from_text(const char *filename, char *content, position_T position);
+
 // get all the tokens in list
 list_T *lexer_get_tokens(lexer_T *lexer);
 
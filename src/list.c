@@ -28,7 +28,8 @@ void list_push(list_T *list, void *item)
 
 	if (list->index >= list->buffer_size)
 	{
-		list->buffer_size = (list->index + 15);
+		// grows by half, so pushing n items copies O(n) of them in total
+		list->buffer_size = (list->index + list->index / 2 + 15);
 		list->buffer = realloc(
 			list->buffer, list->buffer_size * list->item_size
 		);
@@ -0,0 +1,324 @@
+#define _GNU_SOURCE
+#include "lsp.h"
+#include "json.h"
+#include "document.h"
+#include <time.h>
+#include <unistd.h>
+
+// stream of protocol, stdout itself is moved to stderr
+static FILE *OUTPUT = NULL;
+
+static list_T *DOCUMENTS = NULL;
+
+static double milliseconds()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+// message is headers, empty line and content of `Content-Length` bytes. NULL at end of input.
+static char *lsp_read(FILE *input, size_t *length)
+{
+	char header[256];
+	long content_length = -1;
+
+	while (fgets(header, sizeof(header), input))
+	{
+		if (!strcmp(header, "\r\n") || !strcmp(header, "\n"))
+		{
+			if (content_length >= 0) break;
+			continue;
+		}
+
+		if (!strncasecmp(header, "Content-Length:", 15))
+			content_length = strtol(header + 15, NULL, 10);
+	}
+
+	if (content_length < 0 || content_length > LSP_MAX_MESSAGE) return NULL;
+
+	char *content = malloc(content_length + 1);
+	if (fread(content, 1, content_length, input) != (size_t)content_length)
+	{
+		free(content);
+		return NULL;
+	}
+	content[content_length] = '\0';
+	*length = content_length;
+
+	return content;
+}
+
+static void lsp_send(const char *content)
+{
+	fprintf(OUTPUT, "Content-Length: %zu\r\n\r\n%s", strlen(content), content);
+	fflush(OUTPUT);
+}
+
+static void lsp_respond(json_T *id, const char *result)
+{
+	char *written = json_write(id);
+	char *message = formate_string("{\"jsonrpc\":\"2.0\",\"id\":%s,\"result\":%s}", written, result);
+	lsp_send(message);
+	free(message);
+	free(written);
+}
+
+static void lsp_error(json_T *id, int code, const char *text)
+{
+	char *written = json_write(id);
+	char *quoted = json_quote(text);
+	char *message = formate_string("{\"jsonrpc\":\"2.0\",\"id\":%s,\"error\":{\"code\":%d,\"message\":%s}}",
+		written, code, quoted);
+	lsp_send(message);
+	free(message);
+	free(quoted);
+	free(written);
+}
+
+// `file:///a%20b.tl` -> `/a b.tl`, NULL for other schemes.
+static char *uri_to_path(const char *uri)
+{
+	if (strncmp(uri, "file://", 7)) return NULL;
+
+	char *path = malloc(strlen(uri) + 1), *out = path;
+	for (const char *at = uri + 7; *at; ++at)
+	{
+		unsigned int code;
+		if (*at == '%' && sscanf(at + 1, "%2x", &code) == 1)
+		{
+			*out++ = code;
+			at += 2;
+		}
+		else *out++ = *at;
+	}
+	*out = '\0';
+
+	return path;
+}
+
+static document_T *document_find(const char *uri)
+{
+	for (size_t i = 0; i < list_length(DOCUMENTS); ++i)
+	{
+		document_T *document = list_get(DOCUMENTS, i);
+		if (!strcmp(document->uri, uri)) return document;
+	}
+
+	return NULL;
+}
+
+// lines of diagnostics count from 1, those of protocol from 0.
+static void write_diagnostic(FILE *stream, bool *first, diagnostic_T *diagnostic, int64_t moved)
+{
+	uint64_t line = diagnostic->line - 1 + moved, column = diagnostic->column - 1;
+	char *message = json_quote(diagnostic->message);
+
+	fprintf(stream, "%s{\"range\":{\"start\":{\"line\":%lu,\"character\":%lu},"
+		"\"end\":{\"line\":%lu,\"character\":%lu}},\"severity\":%d,\"source\":\"tlang\",\"message\":%s}",
+		*first ? "" : ",", line, column, line, column + diagnostic->length,
+		diagnostic->is_warning ? 2 : 1, message);
+
+	free(message);
+	*first = false;
+}
+
+static void lsp_publish(const char *uri, document_T *document)
+{
+	char *content;
+	size_t size;
+	FILE *stream = open_memstream(&content, &size);
+	char *quoted = json_quote(uri);
+	bool first = true;
+
+	fprintf(stream, "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/publishDiagnostics\","
+		"\"params\":{\"uri\":%s,\"diagnostics\":[", quoted);
+
+	if (document)
+	{
+		for (size_t i = 0; i < list_length(document->diagnostics); ++i)
+			write_diagnostic(stream, &first, list_get(document->diagnostics, i), 0);
+
+		for (size_t i = 0, count = list_length(document->items); i < count; ++i)
+		{
+			item_T *item = document->items->buffer[i];
+			// most items have none, document may have thousands of them
+			if (!item->lex_diagnostics->index && !item->parse_diagnostics->index) continue;
+			for (size_t j = 0; j < list_length(item->lex_diagnostics); ++j)
+				write_diagnostic(stream, &first, list_get(item->lex_diagnostics, j), item->moved);
+			for (size_t j = 0; j < list_length(item->parse_diagnostics); ++j)
+				write_diagnostic(stream, &first, list_get(item->parse_diagnostics, j), item->moved);
+		}
+	}
+
+	fprintf(stream, "]}}");
+	fclose(stream);
+
+	lsp_send(content);
+	free(content);
+	free(quoted);
+}
+
+static void lsp_open(json_T *params)
+{
+	json_T *text_document = json_get(params, "textDocument");
+	const char *uri = json_get_string(text_document, "uri", NULL);
+	const char *text = json_get_string(text_document, "text", NULL);
+	if (!uri || !text) return;
+
+	double start = milliseconds();
+	char *path = uri_to_path(uri);
+	document_T *document = document_find(uri);
+	if (document) document_replace(document, text);
+	else list_push(DOCUMENTS, document = init_document(uri, path, text));
+	free(path);
+
+	fprintf(stderr, "lsp :: opened `%s`, %zu item(s), %.2f ms\n",
+		uri, list_length(document->items), milliseconds() - start);
+	lsp_publish(uri, document);
+}
+
+// changes have ranges (incremental sync), change without one replaces whole text.
+static void lsp_change(json_T *params)
+{
+	const char *uri = json_get_string(json_get(params, "textDocument"), "uri", NULL);
+	json_T *changes = json_get(params, "contentChanges");
+	document_T *document = uri ? document_find(uri) : NULL;
+	if (!document || !changes || changes->type != JSON_ARRAY) return;
+
+	double start = milliseconds();
+	size_t reparsed = 0;
+	for (size_t i = 0; i < list_length(changes->items); ++i)
+	{
+		json_T *change = list_get(changes->items, i);
+		const char *text = json_get_string(change, "text", "");
+		json_T *range = json_get(change, "range");
+
+		if (range)
+		{
+			json_T *from = json_get(range, "start"), *to = json_get(range, "end");
+			document_edit(document,
+				json_get_number(from, "line", 0), json_get_number(from, "character", 0),
+				json_get_number(to, "line", 0), json_get_number(to, "character", 0), text);
+		}
+		else document_replace(document, text);
+
+		reparsed += document->reparsed;
+	}
+
+	fprintf(stderr, "lsp :: changed `%s`, reparsed %zu of %zu item(s), %.2f ms\n",
+		uri, reparsed, list_length(document->items), milliseconds() - start);
+	lsp_publish(uri, document);
+}
+
+// imports may have changed on disk, so they are resolved again.
+static void lsp_save(json_T *params)
+{
+	const char *uri = json_get_string(json_get(params, "textDocument"), "uri", NULL);
+	document_T *document = uri ? document_find(uri) : NULL;
+	if (!document) return;
+
+	char *text = strdup(document->text);
+	document_replace(document, text);
+	free(text);
+
+	lsp_publish(uri, document);
+}
+
+static void lsp_close(json_T *params)
+{
+	const char *uri = json_get_string(json_get(params, "textDocument"), "uri", NULL);
+	document_T *document = uri ? document_find(uri) : NULL;
+	if (!document) return;
+
+	for (size_t i = 0; i < list_length(DOCUMENTS); ++i)
+		if (list_get(DOCUMENTS, i) == document)
+		{
+			DOCUMENTS->buffer[i] = list_get(DOCUMENTS, list_length(DOCUMENTS) - 1);
+			DOCUMENTS->index--;
+			break;
+		}
+
+	lsp_publish(uri, NULL);
+	document_free(document);
+}
+
+static void lsp_hover(json_T *id, json_T *params)
+{
+	const char *uri = json_get_string(json_get(params, "textDocument"), "uri", NULL);
+	json_T *position = json_get(params, "position");
+	document_T *document = uri ? document_find(uri) : NULL;
+
+	char *description = document ? document_describe(document,
+		json_get_number(position, "line", 0), json_get_number(position, "character", 0)) : NULL;
+	if (!description)
+	{
+		lsp_respond(id, "null");
+		return;
+	}
+
+	char *quoted = json_quote(description);
+	char *result = formate_string("{\"contents\":{\"kind\":\"plaintext\",\"value\":%s}}", quoted);
+	lsp_respond(id, result);
+	free(result);
+	free(quoted);
+	free(description);
+}
+
+int lsp_run()
+{
+	// messages of compiler must not mix with protocol.
+	OUTPUT = fdopen(dup(STDOUT_FILENO), "w");
+	dup2(STDERR_FILENO, STDOUT_FILENO);
+	if (!OUTPUT)
+	{
+		perror("err :: failed to open output of protocol: ");
+		return -1;
+	}
+
+	DOCUMENTS = init_list(sizeof(document_T *));
+	bool shutdown = false;
+
+	char *content;
+	size_t length;
+	while ((content = lsp_read(stdin, &length)))
+	{
+		json_T *message = json_parse(content, length);
+		free(content);
+		if (!message)
+		{
+			lsp_error(NULL, -32700, "message is not valid json");
+			continue;
+		}
+
+		const char *method = json_get_string(message, "method", "");
+		json_T *id = json_get(message, "id");
+		json_T *params = json_get(message, "params");
+
+		if (!strcmp(method, "initialize"))
+			lsp_respond(id, "{\"capabilities\":{\"textDocumentSync\":{\"openClose\":true,\"change\":2,"
+				"\"save\":{\"includeText\":false}},\"hoverProvider\":true},\"serverInfo\":{\"name\":\"tlang\"}}");
+		else if (!strcmp(method, "textDocument/didOpen")) lsp_open(params);
+		else if (!strcmp(method, "textDocument/didChange")) lsp_change(params);
+		else if (!strcmp(method, "textDocument/didSave")) lsp_save(params);
+		else if (!strcmp(method, "textDocument/didClose")) lsp_close(params);
+		else if (!strcmp(method, "textDocument/hover")) lsp_hover(id, params);
+		else if (!strcmp(method, "shutdown"))
+		{
+			shutdown = true;
+			lsp_respond(id, "null");
+		}
+		else if (!strcmp(method, "exit"))
+		{
+			json_free(message);
+			return shutdown ? 0 : 1;
+		}
+		// notifications which are not handled are ignored, requests get an error.
+		else if (id && *method) lsp_error(id, -32601, "method is not supported");
+
+		json_free(message);
+	}
+
+	return shutdown ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+#ifndef __lsp_h__
+#define __lsp_h__
+
+#include "glob.h"
+#include "list.h"
+
+// size of symbol table of `--lsp`. symbols of replaced statements are not freed,
+// table is built again (and documents parsed as whole) when half of it is used.
+#define LSP_SYMBOL_SIZE (1 << 18)
+
+// max size of one message of client
+#define LSP_MAX_MESSAGE (256 << 20)
+
+// serves language server protocol on stdin and stdout until client sends `exit`.
+// documents are parsed as they are edited, their errors are published as diagnostics and
+// type of symbol is shown on hover. anything compiler prints goes to stderr.
+// returns 0 if client asked to shut down before it exited.
+int lsp_run();
+
+#endif // __lsp_h__
@@ -1,29 +1,45 @@
 #include <stdio.h>
+#include <unistd.h>
 #include "lexer.h"
 #include "parser.h"
 #include "asmgen.h"
+#include "inline.h"
+#include "bce.h"
+#include "escape.h"
+#include "report.h"
+#include "module.h"
+#include "cache.h"
+#include "server.h"
+#include "batch.h"
+#include "lsp.h"
 #include "glob.h"
 
+// size of symbol table of compile
+#define COMPILE_SYMBOL_SIZE 1024
+
 trie_node_T *token_trie_map;
 trie_node_T *symbol_trie_map;
 uint64_t GLOBAL_INDEX;
 uint64_t LOCAL_INDEX;
 uint64_t SYMBOL_SIZE;
 symbol_T *SYMBOLS;
+uint64_t ERRORS;
+ast_T **FUNCTIONS;
 
-int main(int argc, char **argv)
+// keywords and symbol table, server sets them up once and every compile it forks starts from them.
+static bool init_compiler(uint64_t symbol_size)
 {
-	if (argc < 2)
-	{
-		fprintf(stderr, "no file.\n");
-		return -1;
-	}
+	static bool WARM = false;
+	if (WARM) return true;
 
 	token_trie_map = init_trie_node();
 	trie_insert(token_trie_map, "import", (trie_value_T){ .value.i32 = tt_import });
 	trie_insert(token_trie_map, "return", (trie_value_T){ .value.i32 = tt_return });
 	trie_insert(token_trie_map, "if", 		(trie_value_T){ .value.i32 = tt_if });
 	trie_insert(token_trie_map, "else", 	(trie_value_T){ .value.i32 = tt_else });
+	trie_insert(token_trie_map, "while", 	(trie_value_T){ .value.i32 = tt_while });
+	trie_insert(token_trie_map, "region", (trie_value_T){ .value.i32 = tt_region });
+	trie_insert(token_trie_map, "sizeof", (trie_value_T){ .value.i32 = tt_sizeof });
 	trie_insert(token_trie_map, "void", 	(trie_value_T){ .value.i32 = tt_void });
 	trie_insert(token_trie_map, "char", 	(trie_value_T){ .value.i32 = tt_char });
 	trie_insert(token_trie_map, "str", 		(trie_value_T){ .value.i32 = tt_str });
@@ -39,18 +55,123 @@ int main(int argc, char **argv)
 	trie_insert(token_trie_map, "f64",		(trie_value_T){ .value.i32 = tt_f64 });
 
 	symbol_trie_map = init_trie_node();
-	SYMBOL_SIZE = 1024;
+	SYMBOL_SIZE = symbol_size;
+	ERRORS = 0;
 	GLOBAL_INDEX = 0;
 	LOCAL_INDEX = SYMBOL_SIZE - 1;
 	SYMBOLS = malloc(sizeof(struct SYMBOL_STRUCT) * SYMBOL_SIZE);
 	if (!SYMBOLS)
 	{
 		perror("err :: failed to allocate memory for symbols: ");
+		return false;
+	}
+
+	FUNCTIONS = calloc(SYMBOL_SIZE, sizeof(ast_T *));
+	if (!FUNCTIONS)
+	{
+		perror("err :: failed to allocate memory for functions: ");
+		return false;
+	}
+
+	WARM = true;
+	return true;
+}
+
+static int compile(int argc, char **argv)
+{
+	const char *filename = NULL;
+	const char *output = "out.asm";
+	uint64_t inline_threshold = INLINE_THRESHOLD;
+	bool bce_report = false, print_ast = false;
+	bool time_report = false, time_report_json = false;
+	const char *trace = NULL;
+	int jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	bool use_cache = true, cache_stats = false;
+	const char *cache_dir = NULL;
+	uint64_t cache_size = CACHE_MAX_SIZE;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strncmp(argv[i], "--inline-threshold=", 19))
+			inline_threshold = strtoull(argv[i] + 19, NULL, 10);
+		else if (!strcmp(argv[i], "--bce-report"))
+			bce_report = true;
+		else if (!strcmp(argv[i], "--print-ast"))
+			print_ast = true;
+		else if (!strcmp(argv[i], "--time-report"))
+			time_report = true;
+		else if (!strcmp(argv[i], "--time-report=json"))
+			time_report = time_report_json = true;
+		else if (!strncmp(argv[i], "--trace=", 8))
+			trace = argv[i] + 8;
+		else if (!strncmp(argv[i], "--jobs=", 7))
+			jobs = atoi(argv[i] + 7);
+		else if (!strncmp(argv[i], "--import-path=", 14))
+			module_add_path(argv[i] + 14);
+		else if (!strncmp(argv[i], "--output=", 9))
+			output = argv[i] + 9;
+		else if (!strcmp(argv[i], "--no-cache"))
+			use_cache = false;
+		else if (!strncmp(argv[i], "--cache-dir=", 12))
+			cache_dir = argv[i] + 12;
+		else if (!strncmp(argv[i], "--cache-size=", 13))
+			cache_size = strtoull(argv[i] + 13, NULL, 10) << 20;
+		else if (!strcmp(argv[i], "--cache-stats"))
+			cache_stats = true;
+		else if (argv[i][0] == '-')
+		{
+			fprintf(stderr, "unknown option `%s`.\n", argv[i]);
+			return -1;
+		}
+		else filename = argv[i];
+	}
+
+	// code of functions is kept next to output, it does not need cache directory.
+	bool incremental = use_cache;
+	if (use_cache) use_cache = cache_init(cache_dir, cache_size);
+	if (cache_stats)
+	{
+		cache_print_stats(stdout);
+		if (!filename) return 0;
+	}
+
+	if (!filename)
+	{
+		fprintf(stderr, "no file.\n");
 		return -1;
 	}
 
-	lexer_T *lexer = init_lexer(argv[1]);
-	list_T *tokens = lexer_get_tokens(lexer);
+	if (time_report) report_enable();
+	if (trace) report_trace(trace);
+	report_begin("init");
+
+	if (!init_compiler(COMPILE_SYMBOL_SIZE)) return -1;
+	report_end();
+
+	// file and modules it imports are read and lexed in parallel.
+	report_begin("lex");
+	list_T *modules = load_modules(filename, jobs);
+	report_end();
+	if (!modules) return -1;
+
+	// output depends only on modules and options which change code, hash of main
+	// module covers everything it imports.
+	uint64_t cache_key_value = 0;
+	if (use_cache)
+	{
+		report_begin("cache");
+		module_T *main_module = list_get(modules, list_length(modules) - 1);
+		cache_key_value = cache_key(main_module->hash, &inline_threshold, sizeof(inline_threshold));
+		// report of passes is not cached, it is only printed when they run.
+		bool hit = !bce_report && !print_ast && cache_fetch(cache_key_value, output);
+		report_end();
+
+		if (hit)
+		{
+			if (time_report) report_print(stderr, time_report_json);
+			return report_write_trace() ? 0 : -1;
+		}
+	}
 
 	// printf("\n\n--------------------------\n\n");
 
@@ -64,13 +185,144 @@ int main(int argc, char **argv)
 
 	// printf("\n\n--------------------------\n\n");
 
-	parser_T *parser = init_parser(tokens);
-	ast_T *root = parser_parse(parser);
-	pretty_ast_tree(root, 0);
+	// types are checked while parsing. modules share one symbol table, so they are
+	// parsed (or loaded from their interfaces) one by one, each after modules it imports.
+	report_begin("parse");
+	ast_T *root = NULL;
+	for (size_t i = 0; i < list_length(modules); ++i)
+	{
+		ast_T *tree = module_parse(list_get(modules, i));
+		root = root ? init_ast(ast_join, dnil, NULL, root, NULL, tree, 0) : tree;
+	}
+	report_end();
+	report_count("nodes", ast_cost(root));
+
+	// broken code leaves holes in tree (like `if` without condition), passes expect none.
+	if (ERRORS) return -1;
+
+	report_begin("inline");
+	root = inline_functions(root, inline_threshold);
+	report_end();
+
+	report_begin("bce");
+	root = bce_eliminate(root, bce_report);
+	report_end();
+
+	report_begin("escape");
+	root = escape_allocations(root);
+	report_end();
+
+	// tree is only printed on request, printing it slows every compile.
+	if (print_ast)
+	{
+		report_begin("print_ast");
+		pretty_ast_tree(root, 0);
+		report_end();
+	}
 
 	// printf("\n\n--------------------------\n\n");
 
-	// init_asmgen("out.asm", root);
+	report_begin("emit");
+	init_asmgen(output, root, jobs, incremental);
+	report_end();
+
+	// output of program with errors of code generation is still written, but it is not cached and compile fails.
+	if (use_cache && !ERRORS)
+	{
+		report_begin("cache");
+		cache_store(cache_key_value, output);
+		report_end();
+	}
+
+	if (time_report) report_print(stderr, time_report_json);
+	if (!report_write_trace()) return -1;
+
+	return ERRORS ? -1 : 0;
+}
+
+// `--server` keeps compiler warm and compiles requests of `--client`, which passes
+// all its other arguments to it. `--batch list` or more than one file compiles
+// every file in one process. `--lsp` serves editor on stdin and stdout.
+// every other invocation compiles by itself.
+int main(int argc, char **argv)
+{
+	bool server = false, client = false, lsp = false;
+	const char *socket_path = NULL;
+	list_T *arguments = init_list(sizeof(char *));
+	list_T *files = init_list(sizeof(char *));
+	list_T *options = init_list(sizeof(char *));
+	bool batch = false;
+	int jobs = sysconf(_SC_NPROCESSORS_ONLN);
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!strcmp(argv[i], "--server"))
+			server = true;
+		else if (!strcmp(argv[i], "--client"))
+			client = true;
+		else if (!strcmp(argv[i], "--lsp"))
+			lsp = true;
+		else if (!strncmp(argv[i], "--socket=", 9))
+			socket_path = argv[i] + 9;
+		else if (!strcmp(argv[i], "--batch") && i + 1 < argc)
+		{
+			list_T *listed = batch_read_list(argv[++i]);
+			if (!listed) return -1;
+
+			list_extend(files, listed);
+			batch = true;
+		}
+		else
+		{
+			list_push(arguments, argv[i]);
+			list_push(argv[i][0] == '-' ? options : files, argv[i]);
+			if (!strncmp(argv[i], "--jobs=", 7)) jobs = atoi(argv[i] + 7);
+		}
+	}
+
+	if (lsp)
+	{
+		for (size_t i = 0; i < list_length(arguments); ++i)
+		{
+			const char *argument = list_get(arguments, i);
+			if (!strncmp(argument, "--import-path=", 14)) module_add_path(argument + 14);
+			else
+			{
+				fprintf(stderr, "unknown option of language server `%s`.\n", argument);
+				return -1;
+			}
+		}
+
+		if (!init_compiler(LSP_SYMBOL_SIZE)) return -1;
+		return lsp_run();
+	}
+
+	if (!server && !client && (batch || list_length(files) > 1))
+	{
+		if (!init_compiler(COMPILE_SYMBOL_SIZE)) return -1;
+		return batch_run(files, options, jobs, compile) ? 1 : 0;
+	}
+
+	if (!server && !client) return compile(argc, argv);
+	if (!socket_path) socket_path = server_socket_path();
+
+	if (client)
+		return client_run(socket_path, list_length(arguments), (char **)arguments->buffer);
+
+	// interfaces of library and of given import paths are mapped once, for all compiles.
+	module_preload(NULL);
+	for (size_t i = 0; i < list_length(arguments); ++i)
+	{
+		const char *argument = list_get(arguments, i);
+		if (!strncmp(argument, "--import-path=", 14)) module_preload(argument + 14);
+		else
+		{
+			fprintf(stderr, "unknown option of server `%s`.\n", argument);
+			return -1;
+		}
+	}
+
+	if (!init_compiler(COMPILE_SYMBOL_SIZE)) return -1;
 
-	return 0;
+	return server_run(socket_path, compile);
 }
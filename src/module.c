@@ -0,0 +1,329 @@
+#include "module.h"
+#include <pthread.h>
+#include <unistd.h>
+#include <limits.h>
+#include <libgen.h>
+#include <dirent.h>
+
+static const char *PATHS[MODULE_MAX_PATHS];
+static size_t PATHS_LEN = 0;
+
+// interfaces which server mapped before it forked compiles, they are used instead of files.
+typedef struct {
+	char *path;
+	interface_T *interface;
+} preloaded_T;
+static list_T *PRELOADED = NULL;
+
+// modules which were found so far, workers lex them in order they were found.
+static list_T *MODULES = NULL;
+static size_t NEXT = 0;
+static int ACTIVE = 0;
+static bool FAILED = false;
+static pthread_mutex_t LOCK = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t CHANGED = PTHREAD_COND_INITIALIZER;
+
+void module_add_path(const char *directory)
+{
+	if (PATHS_LEN == MODULE_MAX_PATHS)
+	{
+		printf("warn :: too many import paths, `%s` is ignored.\n", directory);
+		return;
+	}
+
+	PATHS[PATHS_LEN++] = directory;
+}
+
+// resolved path of `directory/name.tl`, NULL if there is no such file.
+static char *module_find_in(const char *directory, const char *name)
+{
+	bool has_extension = strlen(name) > 3 && !strcmp(name + strlen(name) - 3, ".tl");
+	char *path = formate_string("%s/%s%s", directory, name, has_extension ? "" : ".tl");
+
+	char *resolved = realpath(path, NULL);
+	free(path);
+
+	return resolved;
+}
+
+// directory of modules shipped with compiler, NULL if binary of compiler is not found.
+static char *module_library()
+{
+	char *exe = realpath("/proc/self/exe", NULL);
+	if (!exe) return NULL;
+
+	char *lib = formate_string("%s/%s", dirname(exe), MODULE_LIB_DIR);
+	free(exe);
+
+	return lib;
+}
+
+void module_preload(const char *directory)
+{
+	char *lib = directory ? NULL : module_library();
+	if (!directory && !(directory = lib)) return;
+	if (!PRELOADED) PRELOADED = init_list(sizeof(preloaded_T *));
+
+	DIR *dir = opendir(directory);
+	struct dirent *item;
+	while (dir && (item = readdir(dir)))
+	{
+		size_t length = strlen(item->d_name);
+		if (length < 4 || strcmp(item->d_name + length - 4, ".tl" INTERFACE_EXTENSION)) continue;
+
+		char *joined = formate_string("%s/%s", directory, item->d_name);
+		char *path = realpath(joined, NULL);
+		free(joined);
+
+		interface_T *interface = path ? interface_open(path) : NULL;
+		if (!interface)
+		{
+			free(path);
+			continue;
+		}
+
+		preloaded_T *preloaded = malloc(sizeof(preloaded_T));
+		*preloaded = (preloaded_T){ .path = path, .interface = interface };
+		list_push(PRELOADED, preloaded);
+	}
+
+	if (dir) closedir(dir);
+	free(lib);
+}
+
+static char *module_resolve(const char *importer, const char *name)
+{
+	char *copy = strdup(importer);
+	char *resolved = module_find_in(dirname(copy), name);
+	free(copy);
+
+	for (size_t i = 0; !resolved && i < PATHS_LEN; ++i)
+		resolved = module_find_in(PATHS[i], name);
+
+	if (!resolved)
+	{
+		char *lib = module_library();
+		if (lib) resolved = module_find_in(lib, name);
+		free(lib);
+	}
+
+	return resolved;
+}
+
+// module of path, it is added (and later lexed) if it was not found before.
+// called with LOCK held.
+static module_T *module_get(char *path)
+{
+	for (size_t i = 0; i < list_length(MODULES); ++i)
+	{
+		module_T *module = list_get(MODULES, i);
+		if (strcmp(module->path, path)) continue;
+
+		free(path);
+		return module;
+	}
+
+	module_T *module = calloc(1, sizeof(module_T));
+	module->path = path;
+	module->names = init_list(sizeof(char *));
+	module->imports = init_list(sizeof(module_T *));
+	list_push(MODULES, module);
+
+	return module;
+}
+
+// interface next to module, if source did not change since it was written.
+static interface_T *module_open_interface(module_T *module)
+{
+	char *path = formate_string("%s%s", module->path, INTERFACE_EXTENSION);
+	interface_T *interface = NULL;
+
+	for (size_t i = 0; PRELOADED && i < list_length(PRELOADED); ++i)
+	{
+		preloaded_T *preloaded = list_get(PRELOADED, i);
+		if (!strcmp(preloaded->path, path)) interface = preloaded->interface;
+	}
+
+	if (!interface || interface->header->source_hash != module->source_hash)
+		interface = interface_open(path);
+	free(path);
+
+	if (interface && interface->header->source_hash != module->source_hash)
+	{
+		interface_close(interface);
+		return NULL;
+	}
+
+	return interface;
+}
+
+static void module_lex(module_T *module)
+{
+	report_begin_module(module->path);
+	lexer_T *lexer = init_lexer(module->path);
+	module->source_hash = hash_bytes(lexer->content, lexer->content_length - 1, HASH_SEED);
+
+	// imported module which did not change is not lexed, its imports are in interface.
+	if (!module->is_main) module->interface = module_open_interface(module);
+
+	if (module->interface)
+	{
+		for (size_t i = 0; i < module->interface->header->imports; ++i)
+			list_push(module->names, (void*)interface_import(module->interface, i));
+	}
+	else
+	{
+		module->tokens = lexer_get_tokens(lexer);
+		for (size_t i = 0; i + 1 < list_length(module->tokens); ++i)
+		{
+			token_T *token = list_get(module->tokens, i);
+			token_T *name = list_get(module->tokens, i + 1);
+			if (token->type == tt_import && name->type == tt_string) list_push(module->names, name->value);
+		}
+	}
+	report_end();
+
+	// imports are resolved outside of lock, only registering them needs it.
+	list_T *paths = init_list(sizeof(char *));
+	bool failed = false;
+	for (size_t i = 0; i < list_length(module->names); ++i)
+	{
+		const char *name = list_get(module->names, i);
+		char *path = module_resolve(module->path, name);
+		if (!path)
+		{
+			compile_error("err :: module `%s` imported by `%s` is not found.\n", name, module->path);
+			failed = true;
+			continue;
+		}
+		list_push(paths, path);
+	}
+
+	pthread_mutex_lock(&LOCK);
+	for (size_t i = 0; i < list_length(paths); ++i)
+		list_push(module->imports, module_get(list_get(paths, i)));
+	FAILED |= failed;
+	ACTIVE--;
+	pthread_cond_broadcast(&CHANGED);
+	pthread_mutex_unlock(&LOCK);
+
+	list_free(paths);
+}
+
+// takes modules until none is left and no other worker can find a new one.
+static void *module_worker(void *arg)
+{
+	(void)arg;
+
+	pthread_mutex_lock(&LOCK);
+	while (true)
+	{
+		while (NEXT == list_length(MODULES) && ACTIVE > 0)
+			pthread_cond_wait(&CHANGED, &LOCK);
+		if (NEXT == list_length(MODULES)) break;
+
+		module_T *module = list_get(MODULES, NEXT++);
+		ACTIVE++;
+		pthread_mutex_unlock(&LOCK);
+
+		module_lex(module);
+		pthread_mutex_lock(&LOCK);
+	}
+	pthread_mutex_unlock(&LOCK);
+
+	return NULL;
+}
+
+// post-order of imports, so module comes after everything it imports.
+static bool module_order(module_T *module, list_T *order)
+{
+	if (module->visit == 2) return true;
+	if (module->visit == 1)
+	{
+		compile_error("err :: import cycle through `%s`.\n", module->path);
+		return false;
+	}
+
+	module->visit = 1;
+	for (size_t i = 0; i < list_length(module->imports); ++i)
+		if (!module_order(list_get(module->imports, i), order)) return false;
+	module->visit = 2;
+
+	list_push(order, module);
+	return true;
+}
+
+list_T *load_modules(const char *filename, int jobs)
+{
+	char *path = realpath(filename, NULL);
+	if (!path)
+	{
+		compile_error("err :: file `%s` is not found.\n", filename);
+		return NULL;
+	}
+
+	MODULES = init_list(sizeof(module_T *));
+	NEXT = 0;
+	ACTIVE = 0;
+	FAILED = false;
+	module_T *main_module = module_get(path);
+	main_module->is_main = true;
+
+	if (jobs < 1) jobs = 1;
+	pthread_t *workers = malloc(jobs * sizeof(pthread_t));
+	for (int i = 0; i < jobs; ++i)
+		pthread_create(&workers[i], NULL, module_worker, NULL);
+	for (int i = 0; i < jobs; ++i)
+		pthread_join(workers[i], NULL);
+	free(workers);
+
+	if (FAILED) return NULL;
+
+	list_T *order = init_list(sizeof(module_T *));
+	if (!module_order(main_module, order)) return NULL;
+
+	// modules come after their imports, so hashes of imports are already known.
+	for (size_t i = 0; i < list_length(order); ++i)
+	{
+		module_T *module = list_get(order, i);
+		module->hash = module->source_hash;
+		for (size_t j = 0; j < list_length(module->imports); ++j)
+		{
+			module_T *import = list_get(module->imports, j);
+			module->hash = hash_bytes(&import->hash, sizeof(import->hash), module->hash);
+		}
+	}
+
+	return order;
+}
+
+ast_T *module_parse(module_T *module)
+{
+	ast_T *root = NULL;
+	if (module->interface && module->interface->header->hash == module->hash &&
+			interface_load(module->interface, &root))
+		return root;
+
+	// interface is out of date because something module imports has changed.
+	if (!module->tokens)
+	{
+		report_begin_module(module->path);
+		module->tokens = lexer_get_tokens(init_lexer(module->path));
+		report_end();
+	}
+	report_count("tokens", list_length(module->tokens));
+
+	size_t first_global = GLOBAL_INDEX, first_local = LOCAL_INDEX;
+	root = parser_parse(init_parser(module->tokens));
+
+	// interface of module with errors would be loaded next time without reporting them.
+	// errors of lexing all modules are counted before any of them is parsed.
+	if (!module->is_main && !ERRORS)
+	{
+		char *path = formate_string("%s%s", module->path, INTERFACE_EXTENSION);
+		interface_write(path, module->source_hash, module->hash, module->names, root, first_global, first_local);
+		free(path);
+	}
+
+	return root;
+}
@@ -0,0 +1,49 @@
+#ifndef __module_h__
+#define __module_h__
+
+#include "glob.h"
+#include "lexer.h"
+#include "parser.h"
+#include "interface.h"
+
+// directory of modules shipped with compiler, relative to directory of its binary
+#define MODULE_LIB_DIR "../lib/"
+
+// max number of `--import-path` directories
+#define MODULE_MAX_PATHS 16
+
+typedef struct MODULE_STRUCT {
+	// resolved path of file
+	char *path;
+	// file which was given to compiler, its interface is never written
+	bool is_main;
+	// NULL when module was not lexed because its interface is used
+	list_T *tokens;
+	interface_T *interface;
+	// names written after `import` and modules they were resolved to
+	list_T *names;
+	list_T *imports;
+	uint64_t source_hash;
+	// hash of source and of everything it imports
+	uint64_t hash;
+	// state of depth-first walk which orders modules
+	int visit;
+} module_T;
+
+// directories which are searched for imported modules, after directory of importer.
+void module_add_path(const char *directory);
+
+// maps interfaces of modules in directory (or in library of compiler if it is NULL),
+// so compiles which server forks do not open them again.
+void module_preload(const char *directory);
+
+// `import "name";` is resolved to `name.tl`. main module and everything it imports
+// is read and lexed by `jobs` threads, returned list has modules ordered so that
+// each one comes after modules it imports. NULL if module is missing or imports form a cycle.
+list_T *load_modules(const char *filename, int jobs);
+
+// tree of module, from its interface if neither it nor its imports changed since it was written.
+// otherwise module is parsed and interface of imported module is written again.
+ast_T *module_parse(module_T *module);
+
+#endif // __module_h__
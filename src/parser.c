@@ -1,4 +1,5 @@
 #include "parser.h"
+#include "comptime.h"
 
 ast_T *init_ast(
 	ast_type_T type, data_type_T data_type, token_T *token,
@@ -7,7 +8,7 @@ ast_T *init_ast(
 	ast_T *ast = malloc(sizeof(struct AST_STRUCT));
 	if (!ast)
 	{
-		printf("err :: init_ast_dt :: failed to allocate memory.\n");
+		compile_error("err :: init_ast_dt :: failed to allocate memory.\n");
 		return NULL;
 	}
 	ast->type = type;
@@ -32,7 +33,7 @@ ast_T *init_ast_unary(ast_type_T type, data_type_T data_type, token_T *token, as
 
 const char *ast_type_as_string(ast_type_T type)
 {
-	char *v;
+	char *v = "unknown";
 
 	switch (type)
 	{
@@ -40,12 +41,28 @@ const char *ast_type_as_string(ast_type_T type)
 		case ast_sub: v = "ast_sub"; break;
 		case ast_mul: v = "ast_mul"; break;
 		case ast_div: v = "ast_div"; break;
+		case ast_mod: v = "ast_mod"; break;
+		case ast_lt: v = "ast_lt"; break;
+		case ast_lte: v = "ast_lte"; break;
+		case ast_gt: v = "ast_gt"; break;
+		case ast_gte: v = "ast_gte"; break;
+		case ast_eq: v = "ast_eq"; break;
+		case ast_neq: v = "ast_neq"; break;
 		case ast_const: v = "ast_const"; break;
 		case ast_ident: v = "ast_ident"; break;
 		case ast_assign: v = "ast_assign"; break;
 		case ast_function: v = "ast_function"; break;
+		case ast_call: v = "ast_call"; break;
 		case ast_return: v = "ast_return"; break;
 		case ast_at_asm: v = "ast_at_asm"; break;
+		case ast_at_bench: v = "ast_at_bench"; break;
+		case ast_if: v = "ast_if"; break;
+		case ast_select: v = "ast_select"; break;
+		case ast_while: v = "ast_while"; break;
+		case ast_deref: v = "ast_deref"; break;
+		case ast_store: v = "ast_store"; break;
+		case ast_alloca: v = "ast_alloca"; break;
+		case ast_region: v = "ast_region"; break;
 		case ast_join: v = "ast_join"; break;
 		case ast_noop: v = "ast_noop"; break;
 	}
@@ -53,6 +70,46 @@ const char *ast_type_as_string(ast_type_T type)
 	return v;
 }
 
+void flatten_join(ast_T *root, list_T *list)
+{
+	if (!root) return;
+
+	if (root->type == ast_join)
+	{
+		flatten_join(root->left, list);
+		flatten_join(root->right, list);
+	}
+	else list_push(list, root);
+}
+
+ast_T *ast_clone(ast_T *root)
+{
+	if (!root) return NULL;
+
+	return init_ast(
+		root->type, root->data_type, root->token,
+		ast_clone(root->left), ast_clone(root->mid), ast_clone(root->right),
+		root->index
+	);
+}
+
+bool ast_contains(ast_T *root, ast_type_T type)
+{
+	if (!root) return false;
+	if (root->type == type) return true;
+
+	return
+		ast_contains(root->left, type) ||
+		ast_contains(root->mid, type) ||
+		ast_contains(root->right, type);
+}
+
+uint64_t ast_cost(ast_T *root)
+{
+	if (!root) return 0;
+	return 1 + ast_cost(root->left) + ast_cost(root->mid) + ast_cost(root->right);
+}
+
 void pretty_ast_tree(ast_T *root, int level)
 {
 	if (!root) return;
@@ -74,7 +131,10 @@ void pretty_ast_tree(ast_T *root, int level)
 
 	printf("\n");
 
-	pretty_ast_tree(root->left, level + 1);
+	// statements are joined into chain leaning left, its joins are printed on one level
+	// so that long list of statements does not go as many levels deep.
+	bool chained = root->type == ast_join && root->left && root->left->type == ast_join;
+	pretty_ast_tree(root->left, chained ? level : level + 1);
 	pretty_ast_tree(root->mid, level + 1);
 	pretty_ast_tree(root->right, level + 1);
 }
@@ -84,11 +144,14 @@ parser_T *init_parser(list_T *tokens)
 	parser_T *parser = malloc(sizeof(parser_T));
 	if (!parser)
 	{
-		printf("err :: init_parser :: failed to allocate memory.\n");
+		compile_error("err :: init_parser :: failed to allocate memory.\n");
 		return NULL;
 	}
 	parser->tokens = tokens;
 	parser->index = 0;
+	parser->function = NULL;
+	parser->reach = 0;
+	parser->scope = init_list(sizeof(scope_entry_T));
 	parser->token = list_get(parser->tokens, parser->index);
 	return parser;
 }
@@ -99,7 +162,10 @@ token_T *parser_token_peek(parser_T *parser, size_t offset)
 	size_t from_offset = parser->index + offset;
 
 	if (from_offset < list_length(parser->tokens))
+	{
+		if ((ssize_t)from_offset > parser->reach) parser->reach = from_offset;
 		return list_get(parser->tokens, from_offset);
+	}
 
 	return NULL;
 }
@@ -109,21 +175,23 @@ token_T *parser_eat(parser_T *parser, token_type_T token_type)
 	// if current token type matches the token_type,
 	// then move to next token, and return next token.
 	// if token_type is unknown_token then move to next token.
+	// parser never moves past end of file.
 	
-	token_T *token = NULL;
-	if (parser->token->type == token_type || token_type == tt_unknown_token)
+	token_T *token = parser->token;
+	if (parser->token->type == token_type || (token_type == tt_unknown_token && token->type != tt_eof))
 	{
-		token = parser->token;
-
 		parser->index++;
 		parser->token  = list_get(parser->tokens, parser->index);
 	}
-	else
+	else if (token_type != tt_unknown_token)
 	{
 		// TODO: proper error management
-		printf("err :: expected `%s`, got `%s`.\n",
+		compile_error("err :: expected `%s`, got `%s`.\n",
 			token_type_to_string(token_type), token_type_to_string(parser->token->type)
 		);
+
+		// missing token is made up, so parsing goes on as if it was there.
+		token = init_token(token_type, parser->token->position, "");
 	}
 
 	return token;
@@ -133,11 +201,18 @@ int get_token_prec(token_T *token)
 {
 	switch (token->type)
 	{
+		case tt_lt:
+		case tt_lte:
+		case tt_gt:
+		case tt_gte:
+		case tt_eq:
+		case tt_neq: return 1;
 		case tt_plus:
-		case tt_minus: return 1;
+		case tt_minus: return 2;
 		case tt_star:
-		case tt_fslash: return 2;
-		default: printf("err:: uhh get_token_prec, something?!\n"); return 0;
+		case tt_fslash:
+		case tt_mod: return 3;
+		default: compile_error("err:: uhh get_token_prec, something?!\n"); return 0;
 	}
 }
 
@@ -149,33 +224,217 @@ ast_type_T convert_token_type_to_ast_type(token_T *token)
 		case tt_minus: return ast_sub;
 		case tt_star: return ast_mul;
 		case tt_fslash: return ast_div;
-		default: printf("err :: what operations are you doing? bruh...\n"); return ast_noop;
+		case tt_mod: return ast_mod;
+		case tt_lt: return ast_lt;
+		case tt_lte: return ast_lte;
+		case tt_gt: return ast_gt;
+		case tt_gte: return ast_gte;
+		case tt_eq: return ast_eq;
+		case tt_neq: return ast_neq;
+		default: compile_error("err :: what operations are you doing? bruh...\n"); return ast_noop;
+	}
+}
+
+ast_T *parser_parse_at_statement(parser_T *parser);
+ast_T *parser_parse_expr(parser_T *parser, int tok_prec);
+ast_T *parser_parse_compound_statement(parser_T *parser);
+
+data_type_T parser_parse_data_type(parser_T *parser)
+{
+	token_T *token = parser_eat(parser, tt_unknown_token);
+
+	if (token->type != tt_ident)
+		return token_type_to_data_type(token->type);
+
+	// generic types (e.g. array<T>) are passed around as pointer.
+	if (parser->token->type == tt_lt)
+	{
+		size_t depth = 0;
+		do {
+			if (parser->token->type == tt_lt) depth++;
+			else if (parser->token->type == tt_gt) depth--;
+			parser_eat(parser, tt_unknown_token);
+		} while (depth > 0 && parser->token->type != tt_eof);
+
+		return dptr;
+	}
+
+	if (!strcmp(token->value, "ptr")) return dptr;
+
+	compile_error("err :: unknown type `%s`.\n", token->value);
+	return dnil;
+}
+
+size_t parser_declare(parser_T *parser, symbol_T symbol)
+{
+	size_t slot;
+
+	if (parser->function)
+	{
+		symbol.symb_c = CLOCAL;
+		slot = init_locl_symb(symbol);
+
+		scope_entry_T *entry = malloc(sizeof(scope_entry_T));
+		entry->name = symbol.name;
+		entry->shadowed = trie_find(symbol_trie_map, symbol.name);
+		list_push(parser->scope, entry);
+	}
+	else
+	{
+		symbol.symb_c = CGLOBAL;
+		slot = init_glob_symb(symbol);
+	}
+
+	trie_insert(symbol_trie_map, symbol.name, (trie_value_T){ .value.i32 = slot });
+
+	return slot;
+}
+
+void parser_leave_scope(parser_T *parser)
+{
+	// restore whatever locals were shadowing.
+	scope_entry_T *entry;
+	while ((entry = list_pop(parser->scope)))
+	{
+		if (entry->shadowed.is_value)
+			trie_insert(symbol_trie_map, entry->name, entry->shadowed);
+		else
+			trie_delete(symbol_trie_map, entry->name);
+
+		free(entry);
 	}
 }
 
+ast_T *parser_parse_call(parser_T *parser)
+{
+	token_T *name = parser_eat(parser, tt_ident);
+
+	// functions which are not defined (yet), are assumed to return i32 like in C.
+	data_type_T data_type = di32;
+	trie_value_T sv = trie_find(symbol_trie_map, name->value);
+	if (sv.is_value)
+	{
+		if (SYMBOLS[sv.value.i32].symb_s != SFUNC)
+		{
+			compile_error("err :: `%s` is not a function.\n", name->value);
+			return NULL;
+		}
+
+		data_type = SYMBOLS[sv.value.i32].data_type;
+	}
+	else if (builtin_data_type(name->value) != dnil)
+		data_type = builtin_data_type(name->value);
+
+	// index holds number of arguments.
+	ast_T *ast = init_ast_leaf(ast_call, data_type, name, 0);
+
+	parser_eat(parser, tt_lparan);
+	while (parser->token->type != tt_rparan && parser->token->type != tt_eof)
+	{
+		ast_T *arg = parser_parse_expr(parser, 0);
+		if (arg)
+			ast->left = !ast->left ? arg :
+				init_ast(ast_join, dnil, NULL, ast->left, NULL, arg, 0);
+		ast->index++;
+
+		if (parser->token->type == tt_comma)
+			parser_eat(parser, tt_comma);
+	}
+	parser_eat(parser, tt_rparan);
+
+	if (sv.is_value && SYMBOLS[sv.value.i32].u64 != ast->index)
+		compile_error("err :: function `%s` expects %ld arguments, got %ld.\n",
+				name->value, SYMBOLS[sv.value.i32].u64, ast->index);
+
+	return ast;
+}
+
+
+ast_T *parser_parse_sizeof(parser_T *parser)
+{
+	token_T *token = parser_eat(parser, tt_sizeof);
+	parser_eat(parser, tt_lparan);
+
+	data_type_T data_type = dnil;
+	token_T *of = parser_eat(parser, tt_unknown_token);
+	if (of->type == tt_ident)
+	{
+		trie_value_T sv = trie_find(symbol_trie_map, of->value);
+		if (!sv.is_value)
+			compile_error("err :: variable `%s` is not defined.\n", of->value);
+		else data_type = SYMBOLS[sv.value.i32].data_type;
+	}
+	else data_type = token_type_to_data_type(of->type);
+
+	parser_eat(parser, tt_rparan);
+
+	return init_ast_leaf(
+		ast_const, dnil,
+		init_token(tt_const_int, token->position, formate_string("%d", get_data_type_size(data_type))),
+		0
+	);
+}
+
+// `$(pointer, index)` is qword element of memory
+ast_T *parser_parse_deref(parser_T *parser)
+{
+	token_T *token = parser_eat(parser, tt_dollar);
+
+	parser_eat(parser, tt_lparan);
+	ast_T *pointer = parser_parse_expr(parser, 0);
+	parser_eat(parser, tt_comma);
+	ast_T *index = parser_parse_expr(parser, 0);
+	parser_eat(parser, tt_rparan);
+
+	if (!pointer || !index) return NULL;
+	if (pointer->data_type != dptr)
+		compile_error("err :: `$` expects pointer, got `%s`.\n", data_type_to_string(pointer->data_type));
+
+	return init_ast(ast_deref, di64, token, pointer, NULL, index, 0);
+}
+
 ast_T *parser_parse_primary(parser_T *parser)
 {
 	switch (parser->token->type)
 	{
+		case tt_at:
+			return parser_parse_at_statement(parser);
+		case tt_sizeof:
+			return parser_parse_sizeof(parser);
+		case tt_dollar:
+			return parser_parse_deref(parser);
 		case tt_const_int:
 			return init_ast_leaf(ast_const, dnil, parser_eat(parser, tt_unknown_token), 0);
 		case tt_string:
 			return init_ast_leaf(ast_const, dstr, parser_eat(parser, tt_string), 0);
 		case tt_ident:
 		{
+			if (parser_token_peek(parser, 1)->type == tt_lparan)
+				return parser_parse_call(parser);
+
 			token_T *ident = parser_eat(parser, tt_ident);
 			trie_value_T sv = trie_find(symbol_trie_map, ident->value);
 			if (!sv.is_value)
 			{
-				printf("err :: variable `%s` is not defined.\n", ident->value);
+				compile_error("err :: variable `%s` is not defined.\n", ident->value);
 				return NULL;
 			}
 
-			return init_ast_leaf(ast_ident, SYMBOLS[sv.value.i32].data_type, ident, sv.value.i32);
+			symbol_T symbol = SYMBOLS[sv.value.i32];
+
+			// compile-time constants are propagated as literals.
+			if (symbol.is_const)
+				return init_ast_leaf(
+					ast_const, symbol.data_type,
+					init_token(tt_const_int, ident->position, formate_string("%ld", (int64_t)symbol.u64)),
+					0
+				);
+
+			return init_ast_leaf(ast_ident, symbol.data_type, ident, sv.value.i32);
 		}
 		default:
 		{
-			printf("err :: no primary found.\n");
+			compile_error("err :: no primary found.\n");
 			parser_eat(parser, tt_unknown_token);
 			return NULL;
 		}
@@ -196,7 +455,7 @@ ast_T *parser_parse_expr(parser_T *parser, int tok_prec)
 
 	token_T *token = parser->token;
 
-	if (token->type == tt_semi || token->type == tt_rparan)
+	if (token->type == tt_semi || token->type == tt_rparan || token->type == tt_comma)
 		return left;
 
 	while (get_token_prec(token) > tok_prec)
@@ -204,6 +463,14 @@ ast_T *parser_parse_expr(parser_T *parser, int tok_prec)
 		parser_eat(parser, tt_unknown_token);
 
 		ast_T *right = parser_parse_expr(parser, get_token_prec(token));
+		if (!left || !right)
+		{
+			left = NULL;
+			token = parser->token;
+			if (token->type == tt_semi || token->type == tt_rparan || token->type == tt_comma)
+				return left;
+			continue;
+		}
 
 		data_type_T new_type =
 			type_check(convert_token_type_to_ast_type(token),
@@ -214,7 +481,7 @@ ast_T *parser_parse_expr(parser_T *parser, int tok_prec)
 			new_type, token, left, NULL, right, 0);
 
 		token = parser->token;
-		if (token->type == tt_semi || token->type == tt_rparan)
+		if (token->type == tt_semi || token->type == tt_rparan || token->type == tt_comma)
 			return left;
 	}
 
@@ -230,34 +497,32 @@ ast_T *parser_parse_assign(parser_T *parser)
 	{
 		parser_eat(parser, tt_colon);
 
-		token_T *var_type = parser_eat(parser, tt_unknown_token);
-		data_type_T data_type = token_type_to_data_type(var_type->type);
+		data_type_T data_type = parser_parse_data_type(parser);
 		if (data_type == dvoid)
 		{
-			printf("err :: well you cannot put void in variable.\n");
+			compile_error("err :: well you cannot put void in variable.\n");
 			return NULL;
 		}
 
+		// locals are allowed to shadow globals.
 		trie_value_T sv = trie_find(symbol_trie_map, var_name->value);
-		if (sv.is_value)
+		if (sv.is_value && (!parser->function || SYMBOLS[sv.value.i32].symb_c == CLOCAL))
 		{
-			printf("err :: variable `%s` already defined.\n", var_name->value);
+			compile_error("err :: variable `%s` already defined.\n", var_name->value);
 			return NULL;
 		}
 
 		symbol_T symbol = { 0 };
 		symbol.symb_s = SVAR;
-		symbol.symb_c = CGLOBAL;
 		symbol.name = malloc(strlen(var_name->value) + 1);
 		symbol.name = strdup(var_name->value);
 		symbol.data_type = data_type;
+		symbol.arg_reg = symbol.arg_stack = -1;
 
-		size_t slot = init_glob_symb(symbol);
+		size_t slot = parser_declare(parser, symbol);
 		ast->index = slot;
 		ast->data_type = data_type;
 
-		trie_insert(symbol_trie_map, var_name->value, (trie_value_T){ .value.i32 = slot });
-
 		if (parser->token->type == tt_semi)
 			return ast;
 	}
@@ -265,31 +530,282 @@ ast_T *parser_parse_assign(parser_T *parser)
 	trie_value_T sv = trie_find(symbol_trie_map, var_name->value);
 	if (!sv.is_value)
 	{
-		printf("err :: variable `%s` not defined.\n", var_name->value);
+		compile_error("err :: variable `%s` not defined.\n", var_name->value);
+		return NULL;
+	}
+
+	if (SYMBOLS[sv.value.i32].is_const)
+	{
+		compile_error("err :: cannot assign to compile-time constant `%s`.\n", var_name->value);
 		return NULL;
 	}
 
 	parser_eat(parser, tt_assign);
 
+	// declaration initialized by @comptime becomes read-only constant.
+	bool is_comptime =
+		ast->data_type != dnil &&
+		parser->token->type == tt_at &&
+		!strcmp(parser_token_peek(parser, 1)->value, "comptime");
+
 	ast->left = parser_parse_expr(parser, 0);
+	if (!ast->left) return NULL;
+
+	if (ast->data_type == dnil)
+		ast->data_type = SYMBOLS[sv.value.i32].data_type;
+
 	ast->data_type = type_check(ast->type, ast->data_type, ast->left->data_type);
+	ast->index = sv.value.i32;
 
 	SYMBOLS[sv.value.i32].data_type = ast->data_type;
 
+	if (is_comptime && ast->left->type == ast_const)
+	{
+		int64_t value = comptime_truncate(strtoll(ast->left->token->value, NULL, 10), ast->data_type);
+		ast->left->token->value = formate_string("%ld", value);
+
+		SYMBOLS[sv.value.i32].is_const = true;
+		SYMBOLS[sv.value.i32].u64 = (uint64_t)value;
+	}
+
 	return ast;
 }
 
+bool parser_is_function_definition(parser_T *parser)
+{
+	// `name(...)` followed by `:`, `->` or `{` is definition, otherwise it is a call.
+	size_t depth = 0, offset = 1;
+	token_T *token;
+
+	while ((token = parser_token_peek(parser, offset++)) && token->type != tt_eof)
+	{
+		if (token->type == tt_lparan) depth++;
+		else if (token->type == tt_rparan && --depth == 0) break;
+	}
+
+	token = parser_token_peek(parser, offset);
+	return token && (
+		token->type == tt_colon ||
+		token->type == tt_right_arrow ||
+		token->type == tt_lbrace
+	);
+}
+
+ast_T *parser_parse_function(parser_T *parser)
+{
+	token_T *name = parser_eat(parser, tt_ident);
+
+	if (parser->function)
+	{
+		compile_error("err :: function `%s` cannot be defined inside of function.\n", name->value);
+		return NULL;
+	}
+
+	if (trie_find(symbol_trie_map, name->value).is_value)
+	{
+		compile_error("err :: `%s` already defined.\n", name->value);
+		return NULL;
+	}
+
+	symbol_T symbol = { 0 };
+	symbol.symb_s = SFUNC;
+	symbol.symb_c = CGLOBAL;
+	symbol.name = strdup(name->value);
+	symbol.data_type = dvoid;
+	symbol.arg_reg = symbol.arg_stack = -1;
+
+	// inserted before the body, so function can call itself.
+	size_t slot = init_glob_symb(symbol);
+	trie_insert(symbol_trie_map, name->value, (trie_value_T){ .value.i32 = slot });
+
+	ast_T *ast = init_ast_leaf(ast_function, dvoid, name, slot);
+	parser->function = ast;
+
+	// System V AMD64: integers go in rdi, rsi, rdx, rcx, r8, r9
+	// and floats in xmm0-7, rest of them are passed on the stack.
+	int8_t n_int = 0, n_sse = 0, n_stack = 0;
+	uint64_t argc = 0;
+
+	parser_eat(parser, tt_lparan);
+	while (parser->token->type != tt_rparan && parser->token->type != tt_eof)
+	{
+		token_T *param_name;
+		data_type_T param_type;
+
+		// both `name: type` and `type name` are accepted.
+		if (parser->token->type == tt_ident && parser_token_peek(parser, 1)->type == tt_colon)
+		{
+			param_name = parser_eat(parser, tt_ident);
+			parser_eat(parser, tt_colon);
+			param_type = parser_parse_data_type(parser);
+		}
+		else
+		{
+			param_type = parser_parse_data_type(parser);
+			param_name = parser_eat(parser, tt_ident);
+		}
+
+		if (!param_name) return NULL;
+
+		symbol_T param = { 0 };
+		param.symb_s = SVAR;
+		param.name = strdup(param_name->value);
+		param.data_type = param_type;
+		param.is_param = true;
+		param.arg_reg = param.arg_stack = -1;
+
+		if (is_float_data_type(param_type))
+		{
+			if (n_sse < 8) param.arg_reg = n_sse++;
+			else param.arg_stack = n_stack++;
+		}
+		else
+		{
+			if (n_int < 6) param.arg_reg = n_int++;
+			else param.arg_stack = n_stack++;
+		}
+
+		ast_T *p = init_ast_leaf(ast_ident, param_type, param_name, parser_declare(parser, param));
+		ast->mid = !ast->mid ? p : init_ast(ast_join, dnil, NULL, ast->mid, NULL, p, 0);
+		argc++;
+
+		if (parser->token->type == tt_comma)
+			parser_eat(parser, tt_comma);
+	}
+	parser_eat(parser, tt_rparan);
+
+	data_type_T return_type = dvoid;
+	if (parser->token->type == tt_colon)
+	{
+		parser_eat(parser, tt_colon);
+		return_type = parser_parse_data_type(parser);
+	}
+
+	if (parser->token->type == tt_right_arrow)
+		parser_eat(parser, tt_right_arrow);
+
+	SYMBOLS[slot].data_type = return_type;
+	SYMBOLS[slot].u64 = argc;
+	ast->data_type = return_type;
+	FUNCTIONS[slot] = ast;
+
+	ast->left = parser_parse_compound_statement(parser);
+
+	parser_leave_scope(parser);
+	parser->function = NULL;
+
+	return ast;
+}
+
+ast_T *parser_parse_return(parser_T *parser)
+{
+	token_T *token = parser_eat(parser, tt_return);
+
+	if (!parser->function)
+		compile_error("err :: `return` outside of function.\n");
+
+	data_type_T return_type = parser->function ? parser->function->data_type : dnil;
+	ast_T *ast = init_ast_leaf(ast_return, return_type, token, 0);
+
+	if (parser->token->type != tt_semi)
+	{
+		ast->left = parser_parse_expr(parser, 0);
+		if (ast->left)
+			type_check(ast_function, return_type, ast->left->data_type);
+	}
+
+	return ast;
+}
+
+ast_T *parser_parse_statement(parser_T *parser);
+
+// body of if/while: compound or single statement
+ast_T *parser_parse_body(parser_T *parser)
+{
+	if (parser->token->type == tt_lbrace)
+		return parser_parse_compound_statement(parser);
+
+	ast_T *ast = parser_parse_statement(parser);
+	if (parser->token->type == tt_semi)
+		parser_eat(parser, tt_semi);
+
+	return ast;
+}
+
+ast_T *parser_parse_if(parser_T *parser)
+{
+	token_T *token = parser_eat(parser, tt_if);
+
+	parser_eat(parser, tt_lparan);
+	ast_T *condition = parser_parse_expr(parser, 0);
+	parser_eat(parser, tt_rparan);
+
+	ast_T *ast = init_ast(ast_if, dnil, token, condition, NULL, NULL, 0);
+	ast->mid = parser_parse_body(parser);
+
+	if (parser->token->type == tt_else)
+	{
+		parser_eat(parser, tt_else);
+		ast->right = parser_parse_body(parser);
+	}
+
+	return ast;
+}
+
+ast_T *parser_parse_while(parser_T *parser)
+{
+	token_T *token = parser_eat(parser, tt_while);
+
+	parser_eat(parser, tt_lparan);
+	ast_T *condition = parser_parse_expr(parser, 0);
+	parser_eat(parser, tt_rparan);
+
+	ast_T *ast = init_ast(ast_while, dnil, token, condition, NULL, NULL, 0);
+	ast->mid = parser_parse_body(parser);
+
+	return ast;
+}
+
+// everything allocated in `region { ... }` is freed at its end.
+ast_T *parser_parse_region(parser_T *parser)
+{
+	token_T *token = parser_eat(parser, tt_region);
+	ast_T *body = parser_parse_compound_statement(parser);
+
+	return init_ast_unary(ast_region, dnil, token, body, 0);
+}
+
+// `$(pointer, index) = expr`
+ast_T *parser_parse_store(parser_T *parser)
+{
+	ast_T *target = parser_parse_deref(parser);
+	if (parser->token->type != tt_assign) return target;
+
+	token_T *token = parser_eat(parser, tt_assign);
+	ast_T *value = parser_parse_expr(parser, 0);
+
+	if (!target || !value) return NULL;
+	if (value->data_type == dstr)
+		compile_error("err :: cannot store string in memory.\n");
+
+	return init_ast(ast_store, di64, token, target, NULL, value, 0);
+}
+
 ast_T *parser_parse_ident(parser_T *parser)
 {
 	token_T *token = parser_token_peek(parser, 1);
 
 	switch (token->type)
 	{
+		case tt_lparan:
+			return parser_is_function_definition(parser) ?
+				parser_parse_function(parser) :
+				parser_parse_expr(parser, 0);
 		case tt_colon:
 		case tt_assign:
 			return parser_parse_assign(parser);
 		default:
-			printf("err :: well, something is wrong in ident matcher.\n");
+			compile_error("err :: well, something is wrong in ident matcher.\n");
 			parser_eat(parser, tt_unknown_token);
 			return NULL;
 	}
@@ -301,9 +817,53 @@ ast_T *parser_parse_at_statement(parser_T *parser)
 	token_T *kind_of_at = parser_eat(parser, tt_ident);
 	ast_T *ast = NULL;
 
+	// @inline and @noinline overrides inliner heuristic for the next function.
+	if (!strcmp(kind_of_at->value, "inline") || !strcmp(kind_of_at->value, "noinline"))
+	{
+		if (parser->token->type != tt_ident || !parser_is_function_definition(parser))
+		{
+			compile_error("err :: `@%s` must be followed by function definition.\n", kind_of_at->value);
+			return NULL;
+		}
+
+		ast = parser_parse_function(parser);
+		if (ast)
+			SYMBOLS[ast->index].inline_hint =
+				!strcmp(kind_of_at->value, "inline") ? INLINE_ALWAYS : INLINE_NEVER;
+
+		return ast;
+	}
+
+	// @bench("name", iterations) { ... } runs block in timing loop, iterations are optional.
+	if (!strcmp(kind_of_at->value, "bench"))
+	{
+		parser_eat(parser, tt_lparan);
+		token_T *name = parser_eat(parser, tt_string);
+		uint64_t iterations = BENCH_ITERATIONS;
+
+		if (parser->token->type == tt_comma)
+		{
+			parser_eat(parser, tt_comma);
+			iterations = strtoull(parser_eat(parser, tt_const_int)->value, NULL, 10);
+		}
+		parser_eat(parser, tt_rparan);
+
+		if (!iterations)
+		{
+			compile_error("err :: `@bench(\"%s\")` needs at least one iteration.\n", name->value);
+			iterations = 1;
+		}
+
+		return init_ast_unary(ast_at_bench, dnil, name, parser_parse_compound_statement(parser), iterations);
+	}
+
 	parser_eat(parser, tt_lparan);
 	if (!strcmp(kind_of_at->value, "asm"))
 		ast = init_ast_leaf(ast_at_asm, dnil, parser_eat(parser, tt_string), 0);
+	else if (!strcmp(kind_of_at->value, "comptime"))
+		ast = comptime_fold(parser_parse_expr(parser, 0), COMPTIME_STEP_BUDGET);
+	else
+		compile_error("err :: unknown `@%s` statement.\n", kind_of_at->value);
 	parser_eat(parser, tt_rparan);
 
 	return ast;
@@ -317,6 +877,16 @@ ast_T *parser_parse_statement(parser_T *parser)
 	{
 		case tt_ident: left = parser_parse_ident(parser); break;
 		case tt_at: left = parser_parse_at_statement(parser); break;
+		case tt_return: left = parser_parse_return(parser); break;
+		case tt_if: left = parser_parse_if(parser); break;
+		case tt_while: left = parser_parse_while(parser); break;
+		case tt_dollar: left = parser_parse_store(parser); break;
+		case tt_region: left = parser_parse_region(parser); break;
+		// imports are resolved and parsed before module which imports them (see module.c).
+		case tt_import:
+			parser_eat(parser, tt_import);
+			parser_eat(parser, tt_string);
+			break;
 		default: left = parser_parse_expr(parser, 0);
 	}
 
@@ -330,14 +900,18 @@ ast_T *parser_parse_compound_statement(parser_T *parser)
 
 	parser_eat(parser, tt_lbrace);
 
-	while (parser->token->type != tt_rbrace)
+	while (parser->token->type != tt_rbrace && parser->token->type != tt_eof)
 	{
+		ssize_t start = parser->index;
 		switch (parser->token->type)
 		{
 			case tt_lbrace: tree = parser_parse_compound_statement(parser); break;
 			default: tree = parser_parse_statement(parser);
 		}
 
+		// statement which is wrong from its first token is skipped.
+		if (parser->index == start) parser_eat(parser, tt_unknown_token);
+
 		if (parser->token->type == tt_semi)
 			parser_eat(parser, tt_semi);
 
@@ -353,6 +927,26 @@ ast_T *parser_parse_compound_statement(parser_T *parser)
 	return left;
 }
 
+ast_T *parser_parse_item(parser_T *parser)
+{
+	ssize_t start = parser->index;
+	ast_T *tree;
+
+	switch (parser->token->type)
+	{
+		case tt_lbrace: tree = parser_parse_compound_statement(parser); break;
+		default: tree = parser_parse_statement(parser);
+	}
+
+	if (parser->token->type == tt_semi)
+		parser_eat(parser, tt_semi);
+
+	// statement which is wrong from its first token is skipped.
+	if (parser->index == start) parser_eat(parser, tt_unknown_token);
+
+	return tree;
+}
+
 ast_T *parser_parse(parser_T *parser)
 {
 	// this will contain first statement
@@ -361,14 +955,7 @@ ast_T *parser_parse(parser_T *parser)
 
 	while (parser->token->type != tt_eof)
 	{
-		switch (parser->token->type)
-		{
-			case tt_lbrace: tree = parser_parse_compound_statement(parser); break;
-			default: tree = parser_parse_statement(parser);
-		}
-
-		if (parser->token->type == tt_semi)
-			parser_eat(parser, tt_semi);
+		tree = parser_parse_item(parser);
 
 		if (tree)
 		{
@@ -4,6 +4,9 @@
 #include "glob.h"
 #include "lexer.h"
 
+// iterations of `@bench` block, when they are not given
+#define BENCH_ITERATIONS 1000
+
 typedef struct AST_STRUCT ast_T;
 
 typedef struct AST_STRUCT {
@@ -20,8 +23,18 @@ typedef struct {
 	list_T *tokens;
 	token_T *token;
 	ssize_t index;
+	ast_T *function;
+	list_T *scope;
+	// furthest token parser has looked at, what it parsed depends on tokens up to it
+	ssize_t reach;
 } parser_T;
 
+// local symbol that shadows (or not) the previous definition
+typedef struct {
+	const char *name;
+	trie_value_T shadowed;
+} scope_entry_T;
+
 ast_T *init_ast(
 	ast_type_T type, data_type_T data_type, token_T *token,
 	ast_T *left, ast_T *mid, ast_T *right, size_t index
@@ -29,9 +42,17 @@ ast_T *init_ast(
 ast_T *init_ast_leaf(ast_type_T type, data_type_T data_type, token_T *token, size_t index);
 ast_T *init_ast_unary(ast_type_T type, data_type_T data_type, token_T *token, ast_T *left, size_t index);
 
+extern ast_T **FUNCTIONS;
+
 void pretty_ast_tree(ast_T *root, int level);
+void flatten_join(ast_T *root, list_T *list);
+ast_T *ast_clone(ast_T *root);
+bool ast_contains(ast_T *root, ast_type_T type);
+uint64_t ast_cost(ast_T *root);
 
 parser_T *init_parser(list_T *tokens);
+// one statement of top level with `;` which ends it, NULL if it has no tree
+ast_T *parser_parse_item(parser_T *parser);
 ast_T *parser_parse(parser_T *parser);
 
 #endif // __parser_h__
@@ -0,0 +1,312 @@
+#include "report.h"
+#include "json.h"
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+static bool ENABLED = false;
+static bool TRACED = false;
+static const char *TRACE_PATH = NULL;
+static double ORIGIN = 0;
+// thread which enabled report, only its phases are summed into total
+static uint64_t MAIN_THREAD = 0;
+
+static phase_T *PHASES = NULL;
+static size_t PHASES_LEN = 0;
+static size_t PHASES_CAP = 0;
+static pthread_mutex_t PHASES_LOCK = PTHREAD_MUTEX_INITIALIZER;
+
+// phases which have begun and not ended yet, every thread has its own
+static __thread struct {
+	const char *name;
+	const char *category;
+	uint64_t sequence;
+	double wall;
+	double cpu;
+	uint64_t allocations;
+	uint64_t bytes;
+} OPEN[REPORT_MAX_DEPTH];
+static __thread size_t DEPTH = 0;
+// begins which were not measured (functions and modules when report is not traced) and have not ended,
+// at every depth. their ends must not end phase they are nested in.
+static __thread uint64_t SKIPPED[REPORT_MAX_DEPTH];
+static uint64_t SEQUENCE = 0;
+
+static struct {
+	const char *name;
+	uint64_t value;
+} COUNTERS[REPORT_MAX_COUNTERS];
+static size_t COUNTERS_LEN = 0;
+
+static uint64_t ALLOCATIONS = 0;
+static uint64_t ALLOCATED = 0;
+
+// with `--wrap`, calls to malloc go to `__wrap_malloc` and the real one is `__real_malloc`.
+// without it these are never called, so real functions are weak.
+extern void *__real_malloc(size_t size) __attribute__((weak));
+extern void *__real_calloc(size_t n, size_t size) __attribute__((weak));
+extern void *__real_realloc(void *pointer, size_t size) __attribute__((weak));
+
+static void count_allocation(size_t size)
+{
+	__atomic_add_fetch(&ALLOCATIONS, 1, __ATOMIC_RELAXED);
+	__atomic_add_fetch(&ALLOCATED, size, __ATOMIC_RELAXED);
+}
+
+void *__wrap_malloc(size_t size)
+{
+	count_allocation(size);
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+	count_allocation(n * size);
+	return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size)
+{
+	count_allocation(size);
+	return __real_realloc(pointer, size);
+}
+
+static double seconds(clockid_t clock)
+{
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void report_enable()
+{
+	ENABLED = true;
+	ORIGIN = seconds(CLOCK_MONOTONIC);
+	MAIN_THREAD = syscall(SYS_gettid);
+}
+
+void report_trace(const char *path)
+{
+	report_enable();
+	TRACED = true;
+	TRACE_PATH = path;
+}
+
+static void begin(const char *name, const char *category)
+{
+	if (DEPTH >= REPORT_MAX_DEPTH)
+	{
+		printf("err :: phases are nested too deep, `%s` is not measured.\n", name);
+		DEPTH++;
+		return;
+	}
+
+	OPEN[DEPTH].name = name;
+	OPEN[DEPTH].category = category;
+	OPEN[DEPTH].sequence = __atomic_fetch_add(&SEQUENCE, 1, __ATOMIC_RELAXED);
+	OPEN[DEPTH].allocations = __atomic_load_n(&ALLOCATIONS, __ATOMIC_RELAXED);
+	OPEN[DEPTH].bytes = __atomic_load_n(&ALLOCATED, __ATOMIC_RELAXED);
+	OPEN[DEPTH].cpu = seconds(CLOCK_PROCESS_CPUTIME_ID);
+	OPEN[DEPTH].wall = seconds(CLOCK_MONOTONIC);
+	DEPTH++;
+}
+
+void report_begin(const char *name)
+{
+	if (ENABLED) begin(name, "phase");
+}
+
+// phases which are only traced are still begun, so `report_end` knows what it ends.
+static void begin_traced(const char *name, const char *category)
+{
+	if (!ENABLED) return;
+
+	if (TRACED || DEPTH >= REPORT_MAX_DEPTH) begin(name, category);
+	else SKIPPED[DEPTH]++;
+}
+
+void report_begin_function(const char *name)
+{
+	begin_traced(name, "function");
+}
+
+void report_begin_module(const char *path)
+{
+	begin_traced(path, "module");
+}
+
+void report_end()
+{
+	if (!ENABLED) return;
+
+	if (DEPTH < REPORT_MAX_DEPTH && SKIPPED[DEPTH])
+	{
+		SKIPPED[DEPTH]--;
+		return;
+	}
+
+	if (DEPTH == 0)
+	{
+		printf("err :: phase ended which did not begin.\n");
+		return;
+	}
+
+	if (--DEPTH >= REPORT_MAX_DEPTH) return;
+
+	double wall = seconds(CLOCK_MONOTONIC);
+	double cpu = seconds(CLOCK_PROCESS_CPUTIME_ID);
+
+	phase_T phase = {
+		.name = OPEN[DEPTH].name,
+		.category = OPEN[DEPTH].category,
+		.sequence = OPEN[DEPTH].sequence,
+		.depth = DEPTH,
+		.thread = syscall(SYS_gettid),
+		.start = OPEN[DEPTH].wall - ORIGIN,
+		.wall = wall - OPEN[DEPTH].wall,
+		.cpu = cpu - OPEN[DEPTH].cpu,
+		.allocations = __atomic_load_n(&ALLOCATIONS, __ATOMIC_RELAXED) - OPEN[DEPTH].allocations,
+		.bytes = __atomic_load_n(&ALLOCATED, __ATOMIC_RELAXED) - OPEN[DEPTH].bytes
+	};
+
+	pthread_mutex_lock(&PHASES_LOCK);
+	if (PHASES_LEN == PHASES_CAP)
+	{
+		PHASES_CAP = PHASES_CAP ? PHASES_CAP * 2 : 32;
+		PHASES = realloc(PHASES, PHASES_CAP * sizeof(phase_T));
+	}
+	PHASES[PHASES_LEN++] = phase;
+	pthread_mutex_unlock(&PHASES_LOCK);
+}
+
+void report_count(const char *name, uint64_t value)
+{
+	if (!ENABLED) return;
+
+	pthread_mutex_lock(&PHASES_LOCK);
+	size_t i = 0;
+	while (i < COUNTERS_LEN && strcmp(COUNTERS[i].name, name)) i++;
+
+	if (i < REPORT_MAX_COUNTERS)
+	{
+		if (i == COUNTERS_LEN)
+		{
+			COUNTERS[i].name = name;
+			COUNTERS[i].value = 0;
+			COUNTERS_LEN++;
+		}
+		COUNTERS[i].value += value;
+	}
+	pthread_mutex_unlock(&PHASES_LOCK);
+}
+
+static int compare_sequence(const void *a, const void *b)
+{
+	const phase_T *x = a, *y = b;
+	return (x->sequence > y->sequence) - (x->sequence < y->sequence);
+}
+
+void report_print(FILE *out, bool json)
+{
+	// every phase of this thread has ended by now, unless begins and ends are not paired.
+	size_t skipped = 0;
+	for (size_t i = 0; i < REPORT_MAX_DEPTH; ++i) skipped += SKIPPED[i];
+	if (DEPTH || skipped)
+		printf("err :: %ld phase(s) have not ended, times of phases they are nested in are not accurate.\n",
+			DEPTH + skipped);
+
+	// phases end before the phases they are nested in,
+	// they are printed in the order they began.
+	qsort(PHASES, PHASES_LEN, sizeof(phase_T), compare_sequence);
+
+	phase_T total = { .name = "total" };
+	for (size_t i = 0; i < PHASES_LEN; ++i)
+	{
+		if (PHASES[i].depth || PHASES[i].thread != MAIN_THREAD || strcmp(PHASES[i].category, "phase")) continue;
+
+		total.wall += PHASES[i].wall;
+		total.cpu += PHASES[i].cpu;
+		total.allocations += PHASES[i].allocations;
+		total.bytes += PHASES[i].bytes;
+	}
+
+	if (json) fprintf(out, "{\"phases\": [");
+	else fprintf(out, "%-24s %12s %12s %12s %14s\n", "phase", "wall (ms)", "cpu (ms)", "allocs", "bytes");
+
+	bool first = true;
+	for (size_t i = 0; i <= PHASES_LEN; ++i)
+	{
+		phase_T *phase = i < PHASES_LEN ? &PHASES[i] : &total;
+		if (i < PHASES_LEN && strcmp(phase->category, "phase")) continue;
+
+		if (json && i < PHASES_LEN)
+		{
+			char *name = json_quote(phase->name);
+			fprintf(out, "%s\n  {\"name\": %s, \"depth\": %ld, \"wall_ms\": %.3f, \"cpu_ms\": %.3f, "
+				"\"allocations\": %ld, \"bytes\": %ld}",
+				first ? "" : ",", name, phase->depth, phase->wall * 1e3, phase->cpu * 1e3,
+				phase->allocations, phase->bytes);
+			free(name);
+		}
+		else if (json)
+			fprintf(out, "\n],\n\"total\": {\"wall_ms\": %.3f, \"cpu_ms\": %.3f, \"allocations\": %ld, \"bytes\": %ld},\n",
+				phase->wall * 1e3, phase->cpu * 1e3, phase->allocations, phase->bytes);
+		else
+			fprintf(out, "%*s%-*s %12.3f %12.3f %12ld %14ld\n",
+				(int)(2 * phase->depth), "", (int)(24 - 2 * phase->depth), phase->name,
+				phase->wall * 1e3, phase->cpu * 1e3, phase->allocations, phase->bytes);
+		first = false;
+	}
+
+	if (json) fprintf(out, "\"counters\": {");
+	else if (COUNTERS_LEN) fprintf(out, "\n");
+
+	for (size_t i = 0; i < COUNTERS_LEN; ++i)
+	{
+		if (json)
+		{
+			char *name = json_quote(COUNTERS[i].name);
+			fprintf(out, "%s%s: %ld", i ? ", " : "", name, COUNTERS[i].value);
+			free(name);
+		}
+		else fprintf(out, "%-24s %12ld\n", COUNTERS[i].name, COUNTERS[i].value);
+	}
+
+	if (json) fprintf(out, "}}\n");
+}
+
+// names of modules are paths, so names are escaped.
+bool report_write_trace()
+{
+	if (!TRACED) return true;
+
+	FILE *out = fopen(TRACE_PATH, "w");
+	if (!out)
+	{
+		perror("err :: failed to open trace file: ");
+		return false;
+	}
+
+	fprintf(out, "{\"traceEvents\": [\n");
+	fprintf(out, "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": %d, \"tid\": %d, "
+		"\"args\": {\"name\": \"tlang\"}}", getpid(), getpid());
+
+	// complete events (`X`) carry begin and duration, in microseconds.
+	for (size_t i = 0; i < PHASES_LEN; ++i)
+	{
+		phase_T *phase = &PHASES[i];
+		char *name = json_quote(phase->name);
+		fprintf(out, ",\n  {\"name\": %s, \"cat\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+			"\"pid\": %d, \"tid\": %ld, \"args\": {\"cpu_us\": %.3f, \"allocations\": %ld, \"bytes\": %ld}}",
+			name, phase->category, phase->start * 1e6, phase->wall * 1e6,
+			getpid(), phase->thread, phase->cpu * 1e6, phase->allocations, phase->bytes);
+		free(name);
+	}
+
+	fprintf(out, "\n],\n\"displayTimeUnit\": \"ms\"}\n");
+	fclose(out);
+
+	return true;
+}
@@ -0,0 +1,51 @@
+#ifndef __report_h__
+#define __report_h__
+
+#include "glob.h"
+
+// max depth of phases which are nested into each other
+#define REPORT_MAX_DEPTH 16
+// max number of named counters, like tokens or AST nodes
+#define REPORT_MAX_COUNTERS 16
+
+// time and memory that one phase of compiler took
+typedef struct {
+	const char *name;
+	// "phase" for passes of compiler, "function" for work on single function
+	const char *category;
+	// phases are numbered in order they began
+	uint64_t sequence;
+	uint64_t depth;
+	uint64_t thread;
+	// seconds since report was enabled
+	double start;
+	double wall;
+	double cpu;
+	uint64_t allocations;
+	uint64_t bytes;
+} phase_T;
+
+// phases are only measured once report is enabled.
+void report_enable();
+// phases are also written as Chrome trace events to `path` by `report_write_trace`.
+void report_trace(const char *path);
+
+void report_begin(const char *name);
+// like `report_begin`, but only traced, it is not part of printed table.
+void report_begin_function(const char *name);
+void report_begin_module(const char *path);
+void report_end();
+
+// amount of work done by compiler (tokens, nodes, bytes of asm),
+// so time of phases can be turned into throughput.
+void report_count(const char *name, uint64_t value);
+
+// table of phases, or JSON object `{"phases": [...], "total": {...}, "counters": {...}}`.
+// allocations are counted only when compiler is linked with
+// `-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc`.
+void report_print(FILE *out, bool json);
+
+// trace in JSON format of `chrome://tracing` and Perfetto.
+bool report_write_trace();
+
+#endif // __report_h__
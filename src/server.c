@@ -0,0 +1,274 @@
+#define _GNU_SOURCE
+#include "server.h"
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// directory in /tmp is made by whoever comes first, so it is only used
+// when it belongs to user and nobody else can enter it.
+static bool private_directory(const char *path)
+{
+	struct stat st;
+	if (mkdir(path, 0700) && errno != EEXIST)
+	{
+		printf("err :: failed to create directory `%s`: %s.\n", path, strerror(errno));
+		return false;
+	}
+
+	if (lstat(path, &st) || !S_ISDIR(st.st_mode) || st.st_uid != getuid() || (st.st_mode & 077))
+	{
+		printf("err :: directory `%s` is not private to user, socket is not put there.\n", path);
+		return false;
+	}
+
+	return true;
+}
+
+const char *server_socket_path()
+{
+	const char *runtime = getenv("XDG_RUNTIME_DIR");
+	if (runtime && *runtime) return formate_string("%s/%s", runtime, SERVER_SOCKET_NAME);
+
+	const char *directory = formate_string(SERVER_SOCKET_DIRECTORY, getuid());
+	if (!private_directory(directory)) return NULL;
+
+	return formate_string("%s/%s", directory, SERVER_SOCKET_NAME);
+}
+
+// other users may connect to socket given by `--socket`, or listen on it,
+// so both ends check that their peer runs as same user.
+static bool same_user(int connection)
+{
+	struct ucred credentials;
+	socklen_t length = sizeof(credentials);
+	if (getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &credentials, &length))
+		return false;
+
+	return credentials.uid == getuid();
+}
+
+static bool socket_address(const char *path, struct sockaddr_un *address)
+{
+	if (strlen(path) >= sizeof(address->sun_path))
+	{
+		printf("err :: socket path `%s` is too long.\n", path);
+		return false;
+	}
+
+	memset(address, 0, sizeof(*address));
+	address->sun_family = AF_UNIX;
+	strcpy(address->sun_path, path);
+
+	return true;
+}
+
+static bool read_all(int fd, void *data, size_t length)
+{
+	for (size_t done = 0; done < length;)
+	{
+		ssize_t n = read(fd, (char *)data + done, length - done);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		done += n;
+	}
+
+	return true;
+}
+
+static bool write_all(int fd, const void *data, size_t length)
+{
+	for (size_t done = 0; done < length;)
+	{
+		ssize_t n = write(fd, (const char *)data + done, length - done);
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) return false;
+		done += n;
+	}
+
+	return true;
+}
+
+// request is length and `cwd\0argument\0...`, stdout and stderr of client come with length.
+// runs in forked child, so compile may change any state of server.
+static void serve(int connection, compile_T compile)
+{
+	uint32_t length;
+	int fds[2];
+	char control[CMSG_SPACE(sizeof(fds))];
+	struct iovec iov = { .iov_base = &length, .iov_len = sizeof(length) };
+	struct msghdr message = {
+		.msg_iov = &iov, .msg_iovlen = 1,
+		.msg_control = control, .msg_controllen = sizeof(control)
+	};
+
+	if (recvmsg(connection, &message, 0) != sizeof(length)) return;
+
+	struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+	if (!header || header->cmsg_type != SCM_RIGHTS || header->cmsg_len != CMSG_LEN(sizeof(fds)))
+		return;
+	memcpy(fds, CMSG_DATA(header), sizeof(fds));
+
+	if (length == 0 || length > SERVER_MAX_REQUEST) return;
+	char *request = malloc(length + 1);
+	if (!read_all(connection, request, length)) return;
+	request[length] = '\0';
+
+	// program name is not sent, compile skips it like in argv of process.
+	list_T *arguments = init_list(sizeof(char *));
+	list_push(arguments, "tlang");
+	for (char *at = request + strlen(request) + 1; at < request + length; at += strlen(at) + 1)
+		list_push(arguments, at);
+
+	dup2(fds[0], STDOUT_FILENO);
+	dup2(fds[1], STDERR_FILENO);
+	close(fds[0]);
+	close(fds[1]);
+
+	int code = -1;
+	if (chdir(request)) perror("err :: failed to enter working directory of client: ");
+	else code = compile(list_length(arguments), (char **)arguments->buffer);
+
+	fflush(stdout);
+	fflush(stderr);
+	write_all(connection, &code, sizeof(code));
+}
+
+int server_run(const char *path, compile_T compile)
+{
+	struct sockaddr_un address;
+	if (!path || !socket_address(path, &address)) return -1;
+
+	int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (listener < 0)
+	{
+		perror("err :: failed to create socket: ");
+		return -1;
+	}
+
+	unlink(path);
+	if (bind(listener, (struct sockaddr *)&address, sizeof(address)) || listen(listener, SOMAXCONN))
+	{
+		perror("err :: failed to listen on socket: ");
+		close(listener);
+		return -1;
+	}
+
+	// children are reaped by kernel, exit code of compile is sent over connection.
+	signal(SIGCHLD, SIG_IGN);
+	printf("server :: listening on `%s`.\n", path);
+	fflush(stdout);
+
+	while (true)
+	{
+		int connection = accept(listener, NULL, NULL);
+		if (connection < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED) continue;
+			perror("err :: failed to accept connection: ");
+			break;
+		}
+
+		if (!same_user(connection))
+		{
+			printf("warn :: connection of other user is refused.\n");
+			fflush(stdout);
+			close(connection);
+			continue;
+		}
+
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			close(listener);
+			serve(connection, compile);
+			_exit(0);
+		}
+		if (pid < 0) perror("err :: failed to fork compile: ");
+
+		close(connection);
+	}
+
+	close(listener);
+	unlink(path);
+
+	return -1;
+}
+
+int client_run(const char *path, int argc, char **argv)
+{
+	struct sockaddr_un address;
+	if (!path || !socket_address(path, &address)) return -1;
+
+	// descriptors of output go to server, so it must be server of same user.
+	struct stat st;
+	if (!lstat(path, &st) && (!S_ISSOCK(st.st_mode) || st.st_uid != getuid()))
+	{
+		fprintf(stderr, "err :: socket `%s` does not belong to user.\n", path);
+		return -1;
+	}
+
+	int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (connection < 0 || connect(connection, (struct sockaddr *)&address, sizeof(address)))
+	{
+		fprintf(stderr, "err :: cannot connect to server at `%s`: %s.\n", path, strerror(errno));
+		return -1;
+	}
+
+	if (!same_user(connection))
+	{
+		fprintf(stderr, "err :: server at `%s` runs as other user.\n", path);
+		close(connection);
+		return -1;
+	}
+
+	char *cwd = getcwd(NULL, 0);
+	size_t length = strlen(cwd) + 1;
+	for (int i = 0; i < argc; ++i) length += strlen(argv[i]) + 1;
+	if (length > SERVER_MAX_REQUEST)
+	{
+		fprintf(stderr, "err :: arguments are too long for server.\n");
+		return -1;
+	}
+
+	char *request = malloc(length), *at = request;
+	at = stpcpy(at, cwd) + 1;
+	for (int i = 0; i < argc; ++i) at = stpcpy(at, argv[i]) + 1;
+
+	uint32_t header_length = length;
+	int fds[2] = { STDOUT_FILENO, STDERR_FILENO };
+	char control[CMSG_SPACE(sizeof(fds))];
+	memset(control, 0, sizeof(control));
+	struct iovec iov = { .iov_base = &header_length, .iov_len = sizeof(header_length) };
+	struct msghdr message = {
+		.msg_iov = &iov, .msg_iovlen = 1,
+		.msg_control = control, .msg_controllen = sizeof(control)
+	};
+
+	struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN(sizeof(fds));
+	memcpy(CMSG_DATA(header), fds, sizeof(fds));
+
+	// output is flushed, so it does not mix with output which server writes to same files.
+	fflush(stdout);
+	fflush(stderr);
+
+	int code;
+	if (sendmsg(connection, &message, 0) != sizeof(header_length) ||
+			!write_all(connection, request, length) ||
+			!read_all(connection, &code, sizeof(code)))
+	{
+		fprintf(stderr, "err :: server closed connection.\n");
+		code = -1;
+	}
+
+	free(request);
+	free(cwd);
+	close(connection);
+
+	return code;
+}
@@ -0,0 +1,29 @@
+#ifndef __server_h__
+#define __server_h__
+
+#include "glob.h"
+#include "list.h"
+
+// socket of `--server` and `--client` when `--socket` is not given,
+// in $XDG_RUNTIME_DIR or in private directory of user in /tmp
+#define SERVER_SOCKET_NAME "tlang.sock"
+#define SERVER_SOCKET_DIRECTORY "/tmp/tlang-%d"
+
+// max size of request (working directory and arguments)
+#define SERVER_MAX_REQUEST (64 * 1024)
+
+// compiles with arguments as if they were given to compiler, returns its exit code
+typedef int (*compile_T)(int argc, char **argv);
+
+// default socket path, NULL if directory of it is not private to user
+const char *server_socket_path();
+
+// accepts requests until killed. every request is compiled by forked child, which starts
+// from state server prepared and throws all of its changes away by exiting.
+int server_run(const char *path, compile_T compile);
+
+// sends arguments, working directory and own stdout and stderr to server,
+// output of compile goes straight to them. returns exit code of compile.
+int client_run(const char *path, int argc, char **argv);
+
+#endif // __server_h__
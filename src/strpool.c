@@ -0,0 +1,191 @@
+#include "strpool.h"
+#include <pthread.h>
+
+static literal_T *LITERALS = NULL;
+static size_t LITERALS_LEN = 0;
+static size_t LITERALS_CAP = 0;
+// open addressing table of literals by hash of their text, slot holds index + 1, 0 is empty
+static size_t *TABLE = NULL;
+static size_t TABLE_CAP = 0;
+// functions are generated in parallel, they add literals under lock
+static pthread_mutex_t LOCK = PTHREAD_MUTEX_INITIALIZER;
+
+void init_string_pool()
+{
+	LITERALS = NULL;
+	LITERALS_LEN = LITERALS_CAP = 0;
+	TABLE_CAP = 64;
+	TABLE = calloc(TABLE_CAP, sizeof(size_t));
+}
+
+// label comes from text, so it does not depend on order in which functions added literals.
+static const char *literal_label(uint64_t hash)
+{
+	return formate_string("str.%016lx", hash);
+}
+
+// slot of literal with same hash, or empty slot where it goes.
+static size_t table_slot(uint64_t hash)
+{
+	size_t slot = hash & (TABLE_CAP - 1);
+	while (TABLE[slot] && LITERALS[TABLE[slot] - 1].hash != hash)
+		slot = (slot + 1) & (TABLE_CAP - 1);
+
+	return slot;
+}
+
+static void table_grow()
+{
+	free(TABLE);
+	TABLE_CAP *= 2;
+	TABLE = calloc(TABLE_CAP, sizeof(size_t));
+	for (size_t i = 0; i < LITERALS_LEN; ++i)
+		TABLE[table_slot(LITERALS[i].hash)] = i + 1;
+}
+
+const char *string_pool_add(const char *text, bool needs_length)
+{
+	size_t length = strlen(text);
+	uint64_t hash = hash_bytes(text, length, HASH_SEED);
+
+	pthread_mutex_lock(&LOCK);
+	size_t slot = table_slot(hash);
+	size_t id = TABLE[slot] - 1;
+	if (TABLE[slot] && (LITERALS[id].length != length || memcmp(LITERALS[id].text, text, length)))
+	{
+		pthread_mutex_unlock(&LOCK);
+		printf("err :: literals `%s` and `%s` have same hash, they can not be told apart.\n",
+			LITERALS[id].text, text);
+		return NULL;
+	}
+
+	if (TABLE[slot])
+		LITERALS[id].needs_length |= needs_length;
+	else
+	{
+		if (LITERALS_LEN == LITERALS_CAP)
+		{
+			LITERALS_CAP = LITERALS_CAP ? LITERALS_CAP * 2 : 16;
+			LITERALS = realloc(LITERALS, LITERALS_CAP * sizeof(literal_T));
+		}
+
+		LITERALS[LITERALS_LEN] = (literal_T){
+			.text = text,
+			.length = length,
+			.hash = hash,
+			.needs_length = needs_length,
+			.host = -1
+		};
+		TABLE[slot] = ++LITERALS_LEN;
+		if (2 * LITERALS_LEN > TABLE_CAP) table_grow();
+	}
+	pthread_mutex_unlock(&LOCK);
+
+	return literal_label(hash);
+}
+
+// bytes of string as data directive operands, like `"text", 10, 0`.
+static const char *string_to_bytes(const char *s, size_t length)
+{
+	// every byte takes at most `, 255` and closing quote and terminator are added.
+	char *bytes = malloc(5 * length + 8), *out = bytes;
+	bool quoted = false;
+
+	for (size_t i = 0; i < length; ++i)
+	{
+		unsigned char c = s[i];
+		bool printable = c >= ' ' && c <= '~' && c != '"' && c != '\\';
+
+		if (printable && !quoted) out += sprintf(out, i ? ", \"" : "\"");
+		else if (!printable && quoted) *out++ = '"';
+		quoted = printable;
+
+		if (printable) *out++ = c;
+		else out += sprintf(out, "%s%d", i ? ", " : "", c);
+	}
+
+	sprintf(out, "%s%s0", quoted ? "\"" : "", length ? ", " : "");
+	return bytes;
+}
+
+// orders literals by their reversed text, so suffix comes right before
+// the strings ending with it.
+static int compare_reversed(const void *a, const void *b)
+{
+	const literal_T *x = &LITERALS[*(const size_t *)a];
+	const literal_T *y = &LITERALS[*(const size_t *)b];
+
+	for (size_t i = 1; i <= x->length && i <= y->length; ++i)
+	{
+		unsigned char cx = x->text[x->length - i], cy = y->text[y->length - i];
+		if (cx != cy) return cx - cy;
+	}
+
+	return (x->length > y->length) - (x->length < y->length);
+}
+
+static bool is_suffix(literal_T *suffix, literal_T *of)
+{
+	return
+		suffix->length <= of->length &&
+		!memcmp(of->text + of->length - suffix->length, suffix->text, suffix->length);
+}
+
+// literal whose length is never read is put inside of longer literal ending with it,
+// others keep own bytes because their length prefix comes right before them.
+// returns literals in order of their reversed text.
+static size_t *merge_suffixes()
+{
+	size_t *order = malloc(LITERALS_LEN * sizeof(size_t));
+	for (size_t i = 0; i < LITERALS_LEN; ++i) order[i] = i;
+	qsort(order, LITERALS_LEN, sizeof(size_t), compare_reversed);
+
+	ssize_t host = -1;
+	for (size_t i = LITERALS_LEN; i-- > 0;)
+	{
+		literal_T *literal = &LITERALS[order[i]];
+
+		if (host >= 0 && is_suffix(literal, &LITERALS[host]))
+		{
+			if (!literal->needs_length) literal->host = host;
+		}
+		else host = order[i];
+	}
+
+	return order;
+}
+
+const char *string_pool_emit()
+{
+	// literals are written in sorted order, which does not depend on order they were added in.
+	size_t *order = merge_suffixes();
+
+	char *section;
+	size_t size;
+	FILE *stream = open_memstream(&section, &size);
+	fprintf(stream, "align %d\n", STRPOOL_ALIGN);
+	for (size_t k = 0; k < LITERALS_LEN; ++k)
+	{
+		literal_T *literal = &LITERALS[order[k]];
+		if (literal->host >= 0) continue;
+
+		const char *bytes = string_to_bytes(literal->text, literal->length);
+		fprintf(stream, "dq %ld\n%s db %s\nalign %d\n",
+			literal->length, literal_label(literal->hash), bytes, STRPOOL_ALIGN);
+		free((char*)bytes);
+	}
+
+	for (size_t k = 0; k < LITERALS_LEN; ++k)
+	{
+		literal_T *literal = &LITERALS[order[k]];
+		if (literal->host < 0) continue;
+
+		fprintf(stream, "%s = %s + %ld\n",
+			literal_label(literal->hash), literal_label(LITERALS[literal->host].hash),
+			LITERALS[literal->host].length - literal->length);
+	}
+
+	fclose(stream);
+	free(order);
+	return section;
+}
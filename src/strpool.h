@@ -0,0 +1,31 @@
+#ifndef __strpool_h__
+#define __strpool_h__
+
+#include "glob.h"
+
+// literals are preceded by their length (`dq length`), so they are aligned to it
+#define STRPOOL_ALIGN 8
+
+typedef struct {
+	const char *text;
+	size_t length;
+	// hash of text, it names label of literal
+	uint64_t hash;
+	// literal is used as value, so its length prefix is read at runtime
+	bool needs_length;
+	// literal which holds this one as suffix, -1 if it has own bytes
+	ssize_t host;
+} literal_T;
+
+void init_string_pool();
+
+// label of literal, identical literals share one label. functions which are
+// generated in parallel add literals at same time, so pool is locked.
+// NULL when another literal has same hash (so same label), error is printed.
+const char *string_pool_add(const char *text, bool needs_length);
+
+// .rodata with all literals of program, literals which are suffix of
+// another one point into it when their length is never needed.
+const char *string_pool_emit();
+
+#endif // __strpool_h__
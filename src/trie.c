@@ -9,12 +9,15 @@ trie_node_T *init_trie_node()
 		return NULL;
 	}
 
-	node->children = malloc(sizeof(struct TRIE_STRUCT) * 256);
+	node->children = calloc(256, sizeof(trie_node_T *));
 	if (!node->children)
 	{
 		perror("err :: failed to allocate memory for trie node->children: ");
 		return NULL;
 	}
+
+	node->is_terminal = false;
+	node->value = (trie_value_T){ 0 };
 	
 	return node;
 }
@@ -23,9 +26,9 @@ void trie_insert(trie_node_T *node, const char *key, trie_value_T value)
 {
 	for (size_t i = 0; i < strlen(key); ++i)
 	{
-		if (node->children[key[i]] == NULL)
-			node->children[key[i]] = init_trie_node();
-		node = node->children[key[i]];
+		if (node->children[(unsigned char)key[i]] == NULL)
+			node->children[(unsigned char)key[i]] = init_trie_node();
+		node = node->children[(unsigned char)key[i]];
 	}
 	node->value = value;
 	node->is_terminal = true;
@@ -35,10 +38,26 @@ trie_value_T trie_find(trie_node_T *node, const char *key)
 {
 	for (size_t i = 0; i < strlen(key); ++i)
 	{
-		if (node->children[key[i]] == NULL)
+		if (node->children[(unsigned char)key[i]] == NULL)
 			return (trie_value_T) { .is_value = false };
-		node = node->children[key[i]];
+		node = node->children[(unsigned char)key[i]];
+	}
+
+	if (!node->is_terminal)
+		return (trie_value_T) { .is_value = false };
+
+	trie_value_T value = node->value;
+	value.is_value = true;
+	return value;
+}
+
+void trie_delete(trie_node_T *node, const char *key)
+{
+	for (size_t i = 0; i < strlen(key); ++i)
+	{
+		if (node->children[(unsigned char)key[i]] == NULL)
+			return;
+		node = node->children[(unsigned char)key[i]];
 	}
-	node->value.is_value = true;
-	return node->value;
+	node->is_terminal = false;
 }
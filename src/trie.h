@@ -28,5 +28,6 @@ typedef struct TRIE_STRUCT {
 trie_node_T *init_trie_node();
 void trie_insert(trie_node_T *node, const char *key, trie_value_T value);
 trie_value_T trie_find(trie_node_T *node, const char *key);
+void trie_delete(trie_node_T *node, const char *key);
 
 #endif // __trie_h__